@@ -0,0 +1,108 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Common {
+
+/* Least recently used cache split into shards by key hash, each with its own
+   lock and an equal share of the capacity, so lookups from several threads
+   rarely wait on each other */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedLruCache {
+public:
+  ShardedLruCache(size_t capacity, size_t shardCount) : m_shardCapacity(std::max<size_t>(1, capacity / shardCount)) {
+    m_shards.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+      m_shards.emplace_back(new Shard());
+    }
+  }
+
+  ShardedLruCache(const ShardedLruCache&) = delete;
+  ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+  bool get(const Key& key, Value& value) {
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      return false;
+    }
+
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    value = it->second->second;
+    return true;
+  }
+
+  void put(const Key& key, const Value& value) {
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+      it->second->second = value;
+      shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+      return;
+    }
+
+    shard.entries.emplace_front(key, value);
+    shard.index.emplace(key, shard.entries.begin());
+
+    if (shard.entries.size() > m_shardCapacity) {
+      shard.index.erase(shard.entries.back().first);
+      shard.entries.pop_back();
+    }
+  }
+
+  void erase(const Key& key) {
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+      shard.entries.erase(it->second);
+      shard.index.erase(it);
+    }
+  }
+
+  void clear() {
+    for (auto& shard : m_shards) {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      shard->index.clear();
+      shard->entries.clear();
+    }
+  }
+
+private:
+  typedef std::list<std::pair<Key, Value>> Entries;
+
+  struct Shard {
+    std::mutex mutex;
+    Entries entries; // most recently used first
+    std::unordered_map<Key, typename Entries::iterator, Hash> index;
+  };
+
+  Shard& getShard(const Key& key) {
+    // The top bits of the mixed hash pick the shard, the low ones are left to the shard's own table
+    uint64_t mixed = static_cast<uint64_t>(m_hash(key)) * UINT64_C(0x9E3779B97F4A7C15);
+    return *m_shards[(mixed >> 32) % m_shards.size()];
+  }
+
+  Hash m_hash;
+  size_t m_shardCapacity;
+  std::vector<std::unique_ptr<Shard>> m_shards;
+};
+
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace Common {
+
+/* Bounded queue for many producers and consumers that never takes a lock.
+   Every slot carries a sequence number telling whose turn it is, so a push
+   or pop claims a slot with one compare and swap and only fails when the
+   buffer is full or empty. The capacity is rounded up to a power of two */
+template <typename T>
+class RingBuffer {
+public:
+  explicit RingBuffer(size_t capacity) : m_mask(roundCapacity(capacity) - 1), m_cells(new Cell[m_mask + 1]),
+    m_pushPosition(0), m_popPosition(0) {
+    for (size_t i = 0; i <= m_mask; ++i) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+
+  template <typename TT>
+  bool tryPush(TT&& value) {
+    size_t position = m_pushPosition.load(std::memory_order_relaxed);
+
+    for (;;) {
+      Cell& cell = m_cells[position & m_mask];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      ptrdiff_t difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+
+      if (difference == 0) {
+        if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          cell.value = std::forward<TT>(value);
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = m_pushPosition.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool tryPop(T& value) {
+    size_t position = m_popPosition.load(std::memory_order_relaxed);
+
+    for (;;) {
+      Cell& cell = m_cells[position & m_mask];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      ptrdiff_t difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position + 1);
+
+      if (difference == 0) {
+        if (m_popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          value = std::move(cell.value);
+          cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = m_popPosition.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static size_t roundCapacity(size_t capacity) {
+    size_t rounded = 2;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+
+    return rounded;
+  }
+
+  const size_t m_mask;
+  std::unique_ptr<Cell[]> m_cells;
+  // Producers and consumers spin on different positions, they are kept on separate cache lines
+  char m_padding1[64];
+  std::atomic<size_t> m_pushPosition;
+  char m_padding2[64];
+  std::atomic<size_t> m_popPosition;
+};
+
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Common {
+
+ThreadPool::ThreadPool(size_t threadCount) : ThreadPool(threadCount, nullptr, nullptr) {
+}
+
+ThreadPool::ThreadPool(size_t threadCount, std::function<void()>&& threadStarted, std::function<void()>&& threadStopped) :
+  m_threadStarted(std::move(threadStarted)), m_threadStopped(std::move(threadStopped)), m_jobs(std::numeric_limits<size_t>::max()) {
+  if (threadCount == 0) {
+    threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+
+  m_workers.reserve(threadCount);
+  for (size_t i = 0; i < threadCount; ++i) {
+    m_workers.emplace_back(&ThreadPool::workerProcedure, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  /* Pending jobs are still drained, so every future handed out gets a value */
+  m_jobs.close();
+
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+size_t ThreadPool::getThreadCount() const {
+  return m_workers.size();
+}
+
+void ThreadPool::workerProcedure() {
+  if (m_threadStarted) {
+    m_threadStarted();
+  }
+
+  std::function<void()> job;
+
+  while (m_jobs.pop(job)) {
+    job();
+    job = nullptr;
+  }
+
+  if (m_threadStopped) {
+    m_threadStopped();
+  }
+}
+
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "BlockingQueue.h"
+
+namespace Common {
+
+/* A fixed set of worker threads fed from a shared job queue. The threads live
+   as long as the pool does, so callers that fan work out on every block or
+   every batch don't pay for thread creation each time */
+class ThreadPool {
+public:
+  /* A thread count of zero means one thread per hardware thread */
+  explicit ThreadPool(size_t threadCount = 0);
+
+  /* The handlers run on each worker thread when it starts and before it
+     exits, for per-thread resources such as hashing scratchpads */
+  ThreadPool(size_t threadCount, std::function<void()>&& threadStarted, std::function<void()>&& threadStopped);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t getThreadCount() const;
+
+  /* Queues the job and returns a future for its result. Exceptions thrown by
+     the job are rethrown from future::get() */
+  template<typename Job>
+  std::future<typename std::result_of<Job()>::type> addJob(Job&& job) {
+    typedef typename std::result_of<Job()>::type Result;
+
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Job>(job));
+    std::future<Result> result = task->get_future();
+
+    if (!m_jobs.push(std::function<void()>([task] { (*task)(); }))) {
+      throw std::runtime_error("Thread pool is stopped");
+    }
+
+    return result;
+  }
+
+private:
+  void workerProcedure();
+
+  std::function<void()> m_threadStarted;
+  std::function<void()> m_threadStopped;
+  BlockingQueue<std::function<void()>> m_jobs;
+  std::vector<std::thread> m_workers;
+};
+
+}
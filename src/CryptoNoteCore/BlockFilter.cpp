@@ -0,0 +1,218 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "BlockFilter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "CryptoNoteCore/TransactionExtra.h"
+#include "Serialization/ISerializer.h"
+#include "Serialization/SerializationOverloads.h"
+#include "CryptoNoteSerialization.h"
+
+namespace CryptoNote {
+
+namespace {
+
+/* Rice parameter of the set, each item costs about 21 bits and a lookup has
+   a 2^-19 chance of a false positive */
+const unsigned FILTER_BITS_PER_ITEM = 19;
+
+/* Output keys and key images are curve points that already look random, so
+   they are mapped into the set's range straight from their bytes */
+uint64_t getItemValue(const uint8_t* item) {
+  uint64_t value;
+  std::memcpy(&value, item, sizeof(value));
+  return value;
+}
+
+class BitWriter {
+public:
+  explicit BitWriter(BinaryArray& data) : data(data), bitCount(0) {
+  }
+
+  void writeBit(bool bit) {
+    if (bitCount % 8 == 0) {
+      data.push_back(0);
+    }
+
+    if (bit) {
+      data.back() |= static_cast<uint8_t>(0x80 >> (bitCount % 8));
+    }
+
+    ++bitCount;
+  }
+
+  void writeBits(uint64_t value, unsigned count) {
+    while (count > 0) {
+      --count;
+      writeBit(((value >> count) & 1) != 0);
+    }
+  }
+
+private:
+  BinaryArray& data;
+  size_t bitCount;
+};
+
+class BitReader {
+public:
+  explicit BitReader(const BinaryArray& data) : data(data), bitCount(0) {
+  }
+
+  bool readBit() {
+    if (bitCount >= data.size() * 8) {
+      throw std::runtime_error("Block filter is truncated");
+    }
+
+    bool bit = (data[bitCount / 8] & (0x80 >> (bitCount % 8))) != 0;
+    ++bitCount;
+    return bit;
+  }
+
+  uint64_t readBits(unsigned count) {
+    uint64_t value = 0;
+    while (count > 0) {
+      --count;
+      value = (value << 1) | (readBit() ? 1 : 0);
+    }
+
+    return value;
+  }
+
+private:
+  const BinaryArray& data;
+  size_t bitCount;
+};
+
+}
+
+BlockFilterBuilder::BlockFilterBuilder(const Crypto::Hash& blockHash) {
+  filter.blockHash = blockHash;
+  filter.itemCount = 0;
+}
+
+void BlockFilterBuilder::addTransaction(const TransactionPrefix& transaction) {
+  for (const auto& input : transaction.inputs) {
+    if (input.type() == typeid(KeyInput)) {
+      values.push_back(getItemValue(boost::get<KeyInput>(input).keyImage.data));
+    }
+  }
+
+  Crypto::PublicKey publicKey = getTransactionPublicKeyFromExtra(transaction.extra);
+  if (publicKey == NULL_PUBLIC_KEY) {
+    return;
+  }
+
+  bool hasKeyOutputs = false;
+  for (const auto& output : transaction.outputs) {
+    if (output.target.type() == typeid(KeyOutput)) {
+      values.push_back(getItemValue(boost::get<KeyOutput>(output.target).key.data));
+      hasKeyOutputs = true;
+    }
+  }
+
+  // Every output is counted, keys are derived with the output's index in the transaction
+  if (hasKeyOutputs) {
+    filter.transactionPublicKeys.push_back(publicKey);
+    filter.outputCounts.push_back(static_cast<uint32_t>(transaction.outputs.size()));
+  }
+}
+
+BlockFilter BlockFilterBuilder::getFilter() const {
+  BlockFilter result = filter;
+  result.itemCount = static_cast<uint32_t>(values.size());
+  if (values.empty()) {
+    return result;
+  }
+
+  uint64_t range = static_cast<uint64_t>(values.size()) << FILTER_BITS_PER_ITEM;
+
+  std::vector<uint64_t> mapped;
+  mapped.reserve(values.size());
+  for (uint64_t value : values) {
+    mapped.push_back(value % range);
+  }
+
+  std::sort(mapped.begin(), mapped.end());
+
+  BitWriter writer(result.items);
+  uint64_t previous = 0;
+  for (uint64_t value : mapped) {
+    uint64_t delta = value - previous;
+    previous = value;
+
+    for (uint64_t quotient = delta >> FILTER_BITS_PER_ITEM; quotient > 0; --quotient) {
+      writer.writeBit(true);
+    }
+
+    writer.writeBit(false);
+    writer.writeBits(delta, FILTER_BITS_PER_ITEM);
+  }
+
+  return result;
+}
+
+BlockFilterMatcher::BlockFilterMatcher(const BlockFilter& filter) :
+  range(static_cast<uint64_t>(filter.itemCount) << FILTER_BITS_PER_ITEM) {
+  if (filter.transactionPublicKeys.size() != filter.outputCounts.size()) {
+    throw std::runtime_error("Block filter transaction lists don't match");
+  }
+
+  // Every counted output has its key in the set, so a node can't make the wallet derive more keys than it sent
+  uint64_t outputCount = 0;
+  for (uint32_t count : filter.outputCounts) {
+    outputCount += count;
+  }
+
+  if (outputCount > filter.itemCount) {
+    throw std::runtime_error("Block filter has more outputs than items");
+  }
+
+  values.reserve(std::min<size_t>(filter.itemCount, filter.items.size() * 8));
+
+  BitReader reader(filter.items);
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < filter.itemCount; ++i) {
+    uint64_t quotient = 0;
+    while (reader.readBit()) {
+      ++quotient;
+    }
+
+    value += (quotient << FILTER_BITS_PER_ITEM) | reader.readBits(FILTER_BITS_PER_ITEM);
+    if (value >= range) {
+      throw std::runtime_error("Block filter item is out of range");
+    }
+
+    values.push_back(value);
+  }
+}
+
+bool BlockFilterMatcher::mayContain(const Crypto::PublicKey& outputKey) const {
+  return mayContain(outputKey.data);
+}
+
+bool BlockFilterMatcher::mayContain(const Crypto::KeyImage& keyImage) const {
+  return mayContain(keyImage.data);
+}
+
+bool BlockFilterMatcher::mayContain(const uint8_t* item) const {
+  if (values.empty()) {
+    return false;
+  }
+
+  return std::binary_search(values.begin(), values.end(), getItemValue(item) % range);
+}
+
+void serialize(BlockFilter& filter, ISerializer& s) {
+  s(filter.blockHash, "blockHash");
+  serializeAsBinary(filter.transactionPublicKeys, "transactionPublicKeys", s);
+  serializeAsBinary(filter.outputCounts, "outputCounts", s);
+  s(filter.itemCount, "itemCount");
+  serializeAsBinary(filter.items, "items", s);
+}
+
+}
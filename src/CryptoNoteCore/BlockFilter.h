@@ -0,0 +1,64 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <CryptoNote.h>
+#include <CryptoTypes.h>
+
+namespace CryptoNote {
+
+class ISerializer;
+
+/* Compact summary of a block for wallet synchronization. It lists the public
+   key and output count of every transaction, so a wallet can derive the
+   output keys it would own there, and holds a Golomb coded set of the block's
+   output keys and spent key images to check those and its own key images
+   against. Nothing secret leaves the wallet, and only the blocks that match
+   need to be downloaded */
+struct BlockFilter {
+  Crypto::Hash blockHash;
+  std::vector<Crypto::PublicKey> transactionPublicKeys;
+  std::vector<uint32_t> outputCounts;
+  uint32_t itemCount;
+  BinaryArray items;
+};
+
+class BlockFilterBuilder {
+public:
+  explicit BlockFilterBuilder(const Crypto::Hash& blockHash);
+
+  /* Transactions without a public key or key outputs can't pay a wallet, only
+     their key images are added */
+  void addTransaction(const TransactionPrefix& transaction);
+  BlockFilter getFilter() const;
+
+private:
+  BlockFilter filter;
+  std::vector<uint64_t> values;
+};
+
+/* Decodes the set once, for the many lookups a wallet makes per block. About
+   one lookup in 2^19 is a false positive */
+class BlockFilterMatcher {
+public:
+  /* Throws std::runtime_error if the filter is malformed */
+  explicit BlockFilterMatcher(const BlockFilter& filter);
+
+  bool mayContain(const Crypto::PublicKey& outputKey) const;
+  bool mayContain(const Crypto::KeyImage& keyImage) const;
+
+private:
+  bool mayContain(const uint8_t* item) const;
+
+  uint64_t range;
+  std::vector<uint64_t> values;
+};
+
+void serialize(BlockFilter& filter, ISerializer& s);
+
+}
@@ -36,5 +36,18 @@ bool restoreCachedTransactions(const std::vector<BinaryArray>& binaryTransaction
   return true;
 }
 
+void calculateBlockLongHashes(const std::vector<const CachedBlock*>& blocks, Common::ThreadPool& threadPool) {
+  std::vector<std::future<void>> hashes;
+  hashes.reserve(blocks.size());
+
+  for (auto block : blocks) {
+    hashes.push_back(threadPool.addJob([block] { block->getBlockLongHash(); }));
+  }
+
+  for (auto& hash : hashes) {
+    hash.get();
+  }
+}
+
 }
 }
@@ -19,14 +19,20 @@
 
 #include <vector>
 
+#include "CachedBlock.h"
 #include "CachedTransaction.h"
 #include "CryptoNote.h"
 #include "CryptoNoteTools.h"
+#include "Common/ThreadPool.h"
 
 namespace CryptoNote {
 namespace Utils {
 
 bool restoreCachedTransactions(const std::vector<BinaryArray>& binaryTransactions, std::vector<CachedTransaction>& transactions);
 
+// Calculates the long hashes of the blocks on the pool's threads, so the proof of work checks that follow only
+// have to compare the cached hashes against the difficulty
+void calculateBlockLongHashes(const std::vector<const CachedBlock*>& blocks, Common::ThreadPool& threadPool);
+
 } //namespace Utils
 } //namespace CryptoNote
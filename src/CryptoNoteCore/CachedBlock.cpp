@@ -48,30 +48,54 @@ const Crypto::Hash& CachedBlock::getBlockHash() const {
 
 const Crypto::Hash& CachedBlock::getBlockLongHash() const {
   if (!blockLongHash.is_initialized()) {
-    if (block.majorVersion == BLOCK_MAJOR_VERSION_1) {
-      const auto& rawHashingBlock = getBlockHashingBinaryArray();
-      blockLongHash = Hash();
-      cn_slow_hash_v0(rawHashingBlock.data(), rawHashingBlock.size(), blockLongHash.get());
-    } else if ((block.majorVersion == BLOCK_MAJOR_VERSION_2) || (block.majorVersion == BLOCK_MAJOR_VERSION_3)) {
-      const auto& rawHashingBlock = getParentBlockHashingBinaryArray(true);
-      blockLongHash = Hash();
-      cn_slow_hash_v0(rawHashingBlock.data(), rawHashingBlock.size(), blockLongHash.get());
-    } else if (block.majorVersion == BLOCK_MAJOR_VERSION_4) {
-      const auto& rawHashingBlock = getParentBlockHashingBinaryArray(true);
-      blockLongHash = Hash();
-      cn_lite_slow_hash_v1(rawHashingBlock.data(), rawHashingBlock.size(), blockLongHash.get());
-    } else if (block.majorVersion >= BLOCK_MAJOR_VERSION_5) {
-	    const auto& rawHashingBlock = getParentBlockHashingBinaryArray(true);
-      blockLongHash = Hash();
-      cn_soft_shell_slow_hash_v1(rawHashingBlock.data(), rawHashingBlock.size(), blockLongHash.get(), getBlockIndex());
-    } else {
-      throw std::runtime_error("Unknown block major version.");
-    }
+    blockLongHash = Hash();
+    getBlockLongHashes(block.nonce, 0, 1, &blockLongHash.get());
   }
 
   return blockLongHash.get();
 }
 
+void CachedBlock::getBlockLongHashes(uint32_t startNonce, uint32_t nonceStep, size_t count, Crypto::Hash* hashes) const {
+  if (block.majorVersion < BLOCK_MAJOR_VERSION_1) {
+    throw std::runtime_error("Unknown block major version.");
+  }
+
+  BinaryArray rawHashingBlock = getBlockLongHashingBinaryArray();
+  size_t nonceOffset = getNonceOffset();
+
+  if ((block.majorVersion == BLOCK_MAJOR_VERSION_1) || (block.majorVersion == BLOCK_MAJOR_VERSION_2) || (block.majorVersion == BLOCK_MAJOR_VERSION_3)) {
+    cn_slow_hash_nonces(rawHashingBlock.data(), rawHashingBlock.size(), nonceOffset, startNonce, nonceStep, count, hashes,
+                        0, 0, CN_PAGE_SIZE, CN_SCRATCHPAD, CN_ITERATIONS);
+  } else if (block.majorVersion == BLOCK_MAJOR_VERSION_4) {
+    cn_slow_hash_nonces(rawHashingBlock.data(), rawHashingBlock.size(), nonceOffset, startNonce, nonceStep, count, hashes,
+                        1, 1, CN_LITE_PAGE_SIZE, CN_LITE_SCRATCHPAD, CN_LITE_ITERATIONS);
+  } else {
+    uint32_t pageSize, scratchpad, iterations;
+    cn_soft_shell_parameters(getBlockIndex(), pageSize, scratchpad, iterations);
+    cn_slow_hash_nonces(rawHashingBlock.data(), rawHashingBlock.size(), nonceOffset, startNonce, nonceStep, count, hashes,
+                        1, 1, pageSize, scratchpad, iterations);
+  }
+}
+
+const BinaryArray& CachedBlock::getBlockLongHashingBinaryArray() const {
+  if (block.majorVersion == BLOCK_MAJOR_VERSION_1) {
+    return getBlockHashingBinaryArray();
+  }
+
+  return getParentBlockHashingBinaryArray(true);
+}
+
+size_t CachedBlock::getNonceOffset() const {
+  // Both hashing blobs start with the versions and the timestamp as varints, then the previous block hash and the nonce
+  if (block.majorVersion == BLOCK_MAJOR_VERSION_1) {
+    return Tools::get_varint_data(block.majorVersion).size() + Tools::get_varint_data(block.minorVersion).size() +
+      Tools::get_varint_data(block.timestamp).size() + sizeof(Crypto::Hash);
+  }
+
+  return Tools::get_varint_data(block.parentBlock.majorVersion).size() + Tools::get_varint_data(block.parentBlock.minorVersion).size() +
+    Tools::get_varint_data(block.timestamp).size() + sizeof(Crypto::Hash);
+}
+
 const Crypto::Hash& CachedBlock::getAuxiliaryBlockHeaderHash() const {
   if (!auxiliaryBlockHeaderHash.is_initialized()) {
     auxiliaryBlockHeaderHash = getObjectHash(getBlockHashingBinaryArray());
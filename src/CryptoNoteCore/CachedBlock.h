@@ -18,6 +18,9 @@ public:
   const Crypto::Hash& getTransactionTreeHash() const;
   const Crypto::Hash& getBlockHash() const;
   const Crypto::Hash& getBlockLongHash() const;
+  // Long hashes of the block as if its nonce were startNonce + i * nonceStep for i < count, without
+  // rebuilding the hashing blob for every nonce. The block itself is not modified
+  void getBlockLongHashes(uint32_t startNonce, uint32_t nonceStep, size_t count, Crypto::Hash* hashes) const;
   const Crypto::Hash& getAuxiliaryBlockHeaderHash() const;
   const BinaryArray& getBlockHashingBinaryArray() const;
   const BinaryArray& getParentBlockBinaryArray(bool headerOnly) const;
@@ -25,6 +28,9 @@ public:
   uint32_t getBlockIndex() const;
 
 private:
+  const BinaryArray& getBlockLongHashingBinaryArray() const;
+  size_t getNonceOffset() const;
+
   const BlockTemplate& block;
   mutable boost::optional<BinaryArray> blockHashingBinaryArray;
   mutable boost::optional<BinaryArray> parentBlockBinaryArray;
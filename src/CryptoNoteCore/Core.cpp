@@ -6,8 +6,12 @@
 // Please see the included LICENSE file for more information.
 
 #include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <future>
 #include <numeric>
 #include <set>
+#include <thread>
 #include <unordered_set>
 
 #include "Core.h"
@@ -27,8 +31,11 @@
 #include "CryptoNoteCore/TransactionPoolCleaner.h"
 #include "CryptoNoteCore/UpgradeManager.h"
 #include "CryptoNoteCore/Mixins.h"
+#include "CryptoNoteCore/RingSignatureVerifier.h"
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandlerCommon.h"
 
+#include <System/Event.h>
+#include <System/InterruptedException.h>
 #include <System/Timer.h>
 
 #include "TransactionApi.h"
@@ -47,25 +54,110 @@ std::vector<T> preallocateVector(size_t elements) {
 }
 UseGenesis addGenesisBlock = UseGenesis(true);
 
-class TransactionSpentInputsChecker {
+/* Takes the core state lock exclusively for a writer on the dispatcher thread. When readers on the
+   RPC worker threads hold it, the lock is taken and held by a helper thread instead, so the dispatcher
+   keeps serving the network while they finish. The writer itself still runs on the dispatcher */
+class ExclusiveStateLock {
 public:
-  bool haveSpentInputs(const Transaction& transaction) {
-    for (const auto& input : transaction.inputs) {
-      if (input.type() == typeid(KeyInput)) {
-        auto inserted = alreadSpentKeyImages.insert(boost::get<KeyInput>(input).keyImage);
-        if (!inserted.second) {
-          return true;
-        }
+  ExclusiveStateLock(System::Dispatcher& dispatcher, boost::shared_mutex& mutex) : m_mutex(mutex), m_ownedHere(mutex.try_lock()) {
+    if (m_ownedHere) {
+      return;
+    }
+
+    System::Event acquired(dispatcher);
+    System::Event* acquiredEvent = &acquired;
+    m_released = m_release.get_future();
+    m_holder = std::thread([this, &dispatcher, acquiredEvent] {
+      boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+      dispatcher.remoteSpawn([acquiredEvent] { acquiredEvent->set(); });
+      m_released.wait();
+    });
+
+    // The helper refers to the event, so it has to be set even if this context gets interrupted meanwhile
+    bool interrupted = false;
+    while (!acquired.get()) {
+      try {
+        acquired.wait();
+      } catch (System::InterruptedException&) {
+        interrupted = true;
       }
     }
 
-    return false;
+    if (interrupted) {
+      dispatcher.interrupt();
+    }
+  }
+
+  ~ExclusiveStateLock() {
+    if (m_ownedHere) {
+      m_mutex.unlock();
+    } else {
+      m_release.set_value();
+      m_holder.join();
+    }
   }
 
+  ExclusiveStateLock(const ExclusiveStateLock&) = delete;
+  ExclusiveStateLock& operator=(const ExclusiveStateLock&) = delete;
+
 private:
-  std::unordered_set<Crypto::KeyImage> alreadSpentKeyImages;
+  boost::shared_mutex& m_mutex;
+  bool m_ownedHere;
+  std::promise<void> m_release;
+  std::future<void> m_released;
+  std::thread m_holder;
 };
 
+/* Lite blocks of the main chain kept ready for /queryblockslite, so wallet syncs
+   are served without reloading and deserializing the block transactions */
+const size_t LITE_BLOCKS_CACHE_SIZE = 20000;
+const size_t LITE_BLOCKS_CACHE_SHARDS = 16;
+
+BlockShortInfo makeBlockShortInfo(const Crypto::Hash& blockHash, const BinaryArray& block, const std::vector<CachedTransaction>& transactions) {
+  BlockShortInfo blockShortInfo;
+  blockShortInfo.blockId = blockHash;
+  blockShortInfo.block = block;
+
+  blockShortInfo.txPrefixes.reserve(transactions.size());
+  for (const auto& transaction : transactions) {
+    TransactionPrefixInfo prefixInfo;
+    prefixInfo.txHash = transaction.getTransactionHash();
+    prefixInfo.txPrefix = static_cast<const TransactionPrefix&>(transaction.getTransaction());
+    blockShortInfo.txPrefixes.emplace_back(std::move(prefixInfo));
+  }
+
+  return blockShortInfo;
+}
+
+/* Filters are a few hundred bytes at most, so many more of them are kept than
+   lite blocks, wallets fetch them in long runs */
+const size_t BLOCK_FILTERS_CACHE_SIZE = 100000;
+
+BlockFilter makeBlockFilter(const Crypto::Hash& blockHash, const BlockTemplate& block, const std::vector<CachedTransaction>& transactions) {
+  BlockFilterBuilder builder(blockHash);
+  builder.addTransaction(block.baseTransaction);
+  for (const auto& transaction : transactions) {
+    builder.addTransaction(transaction.getTransaction());
+  }
+
+  return builder.getFilter();
+}
+
+BlockFilter makeBlockFilter(const BlockShortInfo& blockShortInfo) {
+  BlockTemplate block;
+  if (!fromBinaryArray(block, blockShortInfo.block)) {
+    throw std::runtime_error("Couldn't deserialize block");
+  }
+
+  BlockFilterBuilder builder(blockShortInfo.blockId);
+  builder.addTransaction(block.baseTransaction);
+  for (const auto& prefixInfo : blockShortInfo.txPrefixes) {
+    builder.addTransaction(prefixInfo.txPrefix);
+  }
+
+  return builder.getFilter();
+}
+
 inline IBlockchainCache* findIndexInChain(IBlockchainCache* blockSegment, const Crypto::Hash& blockHash) {
   assert(blockSegment != nullptr);
   while (blockSegment != nullptr) {
@@ -180,13 +272,71 @@ uint32_t findCommonRoot(IMainChainStorage& storage, IBlockchainCache& rootSegmen
 
 const std::chrono::seconds OUTDATED_TRANSACTION_POLLING_INTERVAL = std::chrono::seconds(60);
 
+// How many blocks per worker thread are decoded ahead of the one being pushed during the import from storage
+const size_t IMPORT_BLOCKS_AHEAD_PER_THREAD = 16;
+
+// A block read from the main chain storage, deserialized and hashed by a worker thread during the import
+struct ImportedBlock {
+  explicit ImportedBlock(RawBlock&& block) :
+    rawBlock(std::move(block)), blockTemplate(extractBlockTemplate(rawBlock)), cachedBlock(blockTemplate), cumulativeSize(0) {
+  }
+
+  RawBlock rawBlock;
+  BlockTemplate blockTemplate;
+  CachedBlock cachedBlock;
+  std::vector<CachedTransaction> transactions;
+  TransactionValidatorState spentOutputs;
+  uint64_t cumulativeSize;
+};
+
+const std::chrono::seconds TRANSACTION_POOL_SNAPSHOT_INTERVAL = std::chrono::seconds(300);
+const std::chrono::seconds MAIN_CHAIN_STORAGE_FLUSH_INTERVAL = std::chrono::seconds(60);
+const uint8_t TRANSACTION_POOL_SNAPSHOT_VERSION = 1;
+
+// A pool transaction as it is written to the snapshot file, along with the time it first reached the pool
+struct PoolSnapshotEntry {
+  uint64_t receiveTime;
+  Transaction transaction;
+
+  void serialize(ISerializer& s) {
+    s(receiveTime, "receive_time");
+    s(transaction, "transaction");
+  }
+};
+
+struct PoolSnapshot {
+  uint8_t version;
+  std::vector<PoolSnapshotEntry> transactions;
+
+  void serialize(ISerializer& s) {
+    s(version, "version");
+    s(transactions, "transactions");
+  }
+};
+
+// A snapshot transaction which passed the checks against the chain and waits for its ring signatures
+struct RestoredPoolTransaction {
+  RestoredPoolTransaction(Transaction&& transaction, uint64_t receiveTime) :
+    cachedTransaction(std::move(transaction)), receiveTime(receiveTime) {
+  }
+
+  CachedTransaction cachedTransaction;
+  uint64_t receiveTime;
+  TransactionValidatorState validatorState;
+  std::vector<RingSignatureCheck> signatureChecks;
+};
+
 }
 
 Core::Core(const Currency& currency, Logging::ILogger& logger, Checkpoints&& checkpoints, System::Dispatcher& dispatcher,
-           std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainchainStorage)
+           std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainchainStorage,
+           const std::string& dataFolder)
     : currency(currency), dispatcher(dispatcher), contextGroup(dispatcher), logger(logger, "Core"), checkpoints(std::move(checkpoints)),
-      upgradeManager(new UpgradeManager()), blockchainCacheFactory(std::move(blockchainCacheFactory)),
-      mainChainStorage(std::move(mainchainStorage)), initialized(false) {
+      upgradeManager(new UpgradeManager()), dataFolder(dataFolder), blockchainCacheFactory(std::move(blockchainCacheFactory)),
+      mainChainStorage(std::move(mainchainStorage)),
+      validationThreadPool(0, [] { slow_hash_reserve_state(CN_PAGE_SIZE); }, [] { slow_hash_release_state(); }),
+      initialized(false), liteBlocksCache(LITE_BLOCKS_CACHE_SIZE, LITE_BLOCKS_CACHE_SHARDS),
+      blockFiltersCache(BLOCK_FILTERS_CACHE_SIZE, LITE_BLOCKS_CACHE_SHARDS) {
 
   upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_2, currency.upgradeHeight(BLOCK_MAJOR_VERSION_2));
   upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_3, currency.upgradeHeight(BLOCK_MAJOR_VERSION_3));
@@ -350,7 +500,7 @@ void Core::getBlocks(const std::vector<Crypto::Hash>& blockHashes, std::vector<R
       uint32_t blockIndex = blockchainSegment->getBlockIndex(hash);
       assert(blockIndex <= blockchainSegment->getTopBlockIndex());
 
-      blocks.push_back(blockchainSegment->getBlockByIndex(blockIndex));
+      blocks.push_back(getRawBlock(blockchainSegment, blockIndex));
     }
   }
 }
@@ -362,7 +512,7 @@ void Core::copyTransactionsToPool(IBlockchainCache* alt) {
       break;
     auto transactions = alt->getRawTransactions(alt->getTransactionHashes());
     for (auto& transaction : transactions) {
-      if (addTransactionToPool(std::move(transaction))) {
+      if (doAddTransactionToPool(transaction)) {
         // TODO: send notification
       }
     }
@@ -416,24 +566,37 @@ bool Core::queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, ui
     currentIndex = mainChain->getTopBlockIndex();
 
     startIndex = findBlockchainSupplement(knownBlockHashes); // throws
+    fullOffset = findQueryFullOffset(startIndex, timestamp);
 
-    // Stops bug where wallets fail to sync, because timestamps have been adjusted after syncronisation.
-    // check for a query of the blocks where the block index is non-zero, but the timestamp is zero
-    // indicating that the originator did not know the internal time of the block, but knew which block
-    // was wanted by index.  Fullfill this by getting the time of m_blocks[startIndex].timestamp.
+    size_t hashesPushed = pushBlockHashes(startIndex, fullOffset, BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT, entries);
 
-    if (startIndex > 0 && timestamp == 0) {
-      if (startIndex <= mainChain->getTopBlockIndex()) {
-        RawBlock block = mainChain->getBlockByIndex(startIndex);
-        auto blockTemplate = extractBlockTemplate(block);
-        timestamp = blockTemplate.timestamp;
-      }
+    if (startIndex + static_cast<uint32_t>(hashesPushed) != fullOffset) {
+      return true;
     }
 
-    fullOffset = mainChain->getTimestampLowerBoundBlockIndex(timestamp);
-    if (fullOffset < startIndex) {
-      fullOffset = startIndex;
-    }
+    fillQueryBlockShortInfo(fullOffset, currentIndex, BLOCKS_SYNCHRONIZING_DEFAULT_COUNT, entries);
+
+    return true;
+  } catch (std::exception& e) {
+    logger(Logging::ERROR) << "Failed to query blocks: " << e.what();
+    return false;
+  }
+}
+
+bool Core::queryBlockFilters(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp, uint32_t& startIndex,
+                             uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockFilter>& entries) const {
+  assert(entries.empty());
+  assert(!chainsLeaves.empty());
+  assert(!chainsStorage.empty());
+
+  throwIfNotInitialized();
+
+  try {
+    IBlockchainCache* mainChain = chainsLeaves[0];
+    currentIndex = mainChain->getTopBlockIndex();
+
+    startIndex = findBlockchainSupplement(knownBlockHashes); // throws
+    fullOffset = findQueryFullOffset(startIndex, timestamp);
 
     size_t hashesPushed = pushBlockHashes(startIndex, fullOffset, BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT, entries);
 
@@ -441,15 +604,62 @@ bool Core::queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, ui
       return true;
     }
 
-    fillQueryBlockShortInfo(fullOffset, currentIndex, BLOCKS_SYNCHRONIZING_DEFAULT_COUNT, entries);
+    fillQueryBlockFilters(fullOffset, currentIndex, BLOCK_FILTERS_SYNCHRONIZING_DEFAULT_COUNT, entries);
 
     return true;
   } catch (std::exception& e) {
-    logger(Logging::ERROR) << "Failed to query blocks: " << e.what();
+    logger(Logging::ERROR) << "Failed to query block filters: " << e.what();
+    return false;
+  }
+}
+
+bool Core::getBlocksLite(const std::vector<Crypto::Hash>& blockHashes, std::vector<BlockShortInfo>& entries) const {
+  assert(entries.empty());
+  assert(!chainsLeaves.empty());
+  assert(!chainsStorage.empty());
+
+  throwIfNotInitialized();
+
+  try {
+    entries.reserve(blockHashes.size());
+    for (const auto& blockHash : blockHashes) {
+      // A block that has left the main chain fails the request, the wallet picks up the switch on its next query
+      IBlockchainCache* segment = findMainChainSegmentContainingBlock(blockHash);
+      if (segment == nullptr) {
+        logger(Logging::DEBUGGING) << "Failed to get lite block " << blockHash << ": not in main chain";
+        return false;
+      }
+
+      entries.emplace_back(getBlockShortInfo(segment->getBlockIndex(blockHash)));
+    }
+
+    return true;
+  } catch (std::exception& e) {
+    logger(Logging::ERROR) << "Failed to get lite blocks: " << e.what();
     return false;
   }
 }
 
+uint32_t Core::findQueryFullOffset(uint32_t startIndex, uint64_t timestamp) const {
+  IBlockchainCache* mainChain = chainsLeaves[0];
+
+  // Stops bug where wallets fail to sync, because timestamps have been adjusted after syncronisation.
+  // check for a query of the blocks where the block index is non-zero, but the timestamp is zero
+  // indicating that the originator did not know the internal time of the block, but knew which block
+  // was wanted by index.  Fullfill this by getting the time of m_blocks[startIndex].timestamp.
+
+  if (startIndex > 0 && timestamp == 0) {
+    if (startIndex <= mainChain->getTopBlockIndex()) {
+      RawBlock block = mainChain->getBlockByIndex(startIndex);
+      auto blockTemplate = extractBlockTemplate(block);
+      timestamp = blockTemplate.timestamp;
+    }
+  }
+
+  uint32_t fullOffset = mainChain->getTimestampLowerBoundBlockIndex(timestamp);
+  return std::max(fullOffset, startIndex);
+}
+
 void Core::getTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<BinaryArray>& transactions,
                            std::vector<Crypto::Hash>& missedHashes) const {
   assert(!chainsLeaves.empty());
@@ -532,8 +742,27 @@ std::vector<Crypto::Hash> Core::findBlockchainSupplement(const std::vector<Crypt
   return getBlockHashes(startBlockIndex, static_cast<uint32_t>(maxCount));
 }
 
+Common::ThreadPool& Core::getValidationThreadPool() {
+  return validationThreadPool;
+}
+
+void Core::precalculateBlockLongHashes(const std::vector<CachedBlock>& blocks) {
+  std::vector<const CachedBlock*> blocksToHash;
+  blocksToHash.reserve(blocks.size());
+
+  for (const auto& block : blocks) {
+    // blocks in the checkpoint zone are checked against the checkpoints instead
+    if (!checkpoints.isInCheckpointZone(block.getBlockIndex())) {
+      blocksToHash.push_back(&block);
+    }
+  }
+
+  Utils::calculateBlockLongHashes(blocksToHash, validationThreadPool);
+}
+
 std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlock) {
   throwIfNotInitialized();
+  ExclusiveStateLock lock(dispatcher, stateMutex);
   uint32_t blockIndex = cachedBlock.getBlockIndex();
   Crypto::Hash blockHash = cachedBlock.getBlockHash();
   std::ostringstream os;
@@ -616,11 +845,31 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
   }
 
   uint64_t cumulativeFee = 0;
+  std::vector<RingSignatureCheck> signatureChecks;
+
+  // The key image and output checks depend on each other and stay in order, the ring signatures
+  // don't, so they are checked for the whole block at once on the validation threads
+  auto checkRingSignatures = [&]() -> std::error_code {
+    auto failedCheck = verifyRingSignatures(signatureChecks, &validationThreadPool);
+    if (failedCheck != signatureChecks.size()) {
+      std::error_code transactionValidationResult = error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
+      logger(Logging::DEBUGGING) << "Failed to validate transaction " << signatureChecks[failedCheck].transaction->getTransactionHash()
+                                 << ": " << transactionValidationResult.message();
+      return transactionValidationResult;
+    }
+
+    return error::TransactionValidationError::VALIDATION_SUCCESS;
+  };
 
   for (const auto& transaction : transactions) {
     uint64_t fee = 0;
-    auto transactionValidationResult = validateTransaction(transaction, validatorState, cache, fee, previousBlockIndex);
+    auto transactionValidationResult = validateTransaction(transaction, validatorState, cache, fee, previousBlockIndex, signatureChecks);
     if (transactionValidationResult) {
+      // The signatures collected so far come before the failed check, a bad one among them is reported first
+      if (auto signaturesResult = checkRingSignatures()) {
+        return signaturesResult;
+      }
+
       logger(Logging::DEBUGGING) << "Failed to validate transaction " << transaction.getTransactionHash() << ": " << transactionValidationResult.message();
       return transactionValidationResult;
     }
@@ -628,6 +877,10 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
     cumulativeFee += fee;
   }
 
+  if (auto signaturesResult = checkRingSignatures()) {
+    return signaturesResult;
+  }
+
   uint64_t reward = 0;
   int64_t emissionChange = 0;
   auto alreadyGeneratedCoins = cache->getAlreadyGeneratedCoins(previousBlockIndex);
@@ -666,6 +919,8 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
       // TODO: exception safety
       if (cache == chainsLeaves[0]) {
         mainChainStorage->pushBlock(rawBlock);
+        liteBlocksCache.put(blockIndex, makeBlockShortInfo(blockHash, rawBlock.block, transactions));
+        blockFiltersCache.put(blockIndex, makeBlockFilter(blockHash, cachedBlock.getBlock(), transactions));
 
         cache->pushBlock(cachedBlock, transactions, validatorState, cumulativeBlockSize, emissionChange, currentDifficulty, std::move(rawBlock));
 
@@ -692,12 +947,13 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
           std::swap(chainsLeaves[0], chainsLeaves[endpointIndex]);
           updateMainChainSet();
 
+          // Switched right away, main chain raw blocks are read from the storage from here on
+          switchMainChainStorage(*chainsLeaves[0]);
+
           updateBlockMedianSize();
           actualizePoolTransactions();
           copyTransactionsToPool(chainsLeaves[endpointIndex]);
 
-          switchMainChainStorage(chainsLeaves[0]->getStartBlockIndex(), *chainsLeaves[0]);
-
           ret = error::AddBlockErrorCode::ADDED_TO_ALTERNATIVE_AND_SWITCHED;
 
           logger(Logging::INFO) << "Resolved: " << blockStr
@@ -765,38 +1021,63 @@ void Core::actualizePoolTransactions() {
   auto& pool = *transactionPool;
   auto hashes = pool.getTransactionHashes();
 
-  for (auto& hash : hashes) {
-    auto tx = pool.getTransaction(hash);
-    pool.removeTransaction(hash);
+  /* The transactions are checked against the new main chain where they are, so the ones which stay
+     valid aren't removed and pushed back. The ring signatures are verified on the validation threads */
+  std::vector<std::vector<RingSignatureCheck>> signatureChecks(hashes.size());
+  std::vector<bool> valid(hashes.size());
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    TransactionValidatorState validatorState;
+    valid[i] = isTransactionValidForPool(pool.getTransaction(hashes[i]), validatorState, signatureChecks[i]);
+  }
+
+  std::vector<std::future<bool>> signaturesValid;
+  signaturesValid.reserve(hashes.size());
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    const auto& checks = signatureChecks[i];
+    signaturesValid.push_back(validationThreadPool.addJob([&checks] {
+      return verifyRingSignatures(checks, nullptr) == checks.size();
+    }));
+  }
 
-    if (!addTransactionToPool(std::move(tx))) {
-      notifyObservers(makeDelTransactionMessage({hash}, Messages::DeleteTransaction::Reason::NotActual));
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    if (signaturesValid[i].get() && valid[i]) {
+      continue;
     }
+
+    pool.removeTransaction(hashes[i]);
+    notifyObservers(makeDelTransactionMessage({hashes[i]}, Messages::DeleteTransaction::Reason::NotActual));
   }
 }
 
 void Core::actualizePoolTransactionsLite(const TransactionValidatorState& validatorState) {
   auto& pool = *transactionPool;
-  auto hashes = pool.getTransactionHashes();
 
-  for (auto& hash : hashes) {
-    auto tx = pool.getTransaction(hash);
+  // Only the transactions spending the block's key images or grown too big for the new median can go
+  auto hashes = pool.getTransactionHashesByKeyImages(validatorState);
+  auto oversizedHashes = pool.getTransactionHashesLargerThan(getMaximumTransactionAllowedSize(blockMedianSize, currency));
+  hashes.insert(hashes.end(), oversizedHashes.begin(), oversizedHashes.end());
 
-    auto txState = extractSpentOutputs(tx);
-
-    if (hasIntersections(validatorState, txState) || tx.getTransactionBinaryArray().size() > getMaximumTransactionAllowedSize(blockMedianSize, currency)) {
-      pool.removeTransaction(hash);
+  for (auto& hash : hashes) {
+    if (pool.removeTransaction(hash)) {
       notifyObservers(makeDelTransactionMessage({ hash }, Messages::DeleteTransaction::Reason::NotActual));
     }
   }
 }
 
-void Core::switchMainChainStorage(uint32_t splitBlockIndex, IBlockchainCache& newChain) {
-  assert(mainChainStorage->getBlockCount() > splitBlockIndex);
+void Core::switchMainChainStorage(IBlockchainCache& newChain) {
+  /* The leaf segment may sit on other alternative segments, so the chains part below its start
+     where the stored block and the new chain's block first differ */
+  uint32_t splitBlockIndex = std::min(newChain.getStartBlockIndex(), mainChainStorage->getBlockCount());
+  while (splitBlockIndex > 0 &&
+         getBlockHash(mainChainStorage->getBlockByIndex(splitBlockIndex - 1)) != newChain.getBlockHash(splitBlockIndex - 1)) {
+    --splitBlockIndex;
+  }
 
   auto blocksToPop = mainChainStorage->getBlockCount() - splitBlockIndex;
   for (size_t i = 0; i < blocksToPop; ++i) {
     mainChainStorage->popBlock();
+    liteBlocksCache.erase(splitBlockIndex + static_cast<uint32_t>(i));
+    blockFiltersCache.erase(splitBlockIndex + static_cast<uint32_t>(i));
   }
 
   for (uint32_t index = splitBlockIndex; index <= newChain.getTopBlockIndex(); ++index) {
@@ -931,7 +1212,12 @@ bool Core::getRandomOutputs(uint64_t amount, uint16_t count, std::vector<uint32_
 
 bool Core::addTransactionToPool(const BinaryArray& transactionBinaryArray) {
   throwIfNotInitialized();
+  ExclusiveStateLock lock(dispatcher, stateMutex);
+
+  return doAddTransactionToPool(transactionBinaryArray);
+}
 
+bool Core::doAddTransactionToPool(const BinaryArray& transactionBinaryArray) {
   Transaction transaction;
   if (!fromBinaryArray<Transaction>(transaction, transactionBinaryArray)) {
     logger(Logging::WARNING) << "Couldn't add transaction to pool due to deserialization error";
@@ -968,6 +1254,22 @@ bool Core::addTransactionToPool(CachedTransaction&& cachedTransaction) {
 }
 
 bool Core::isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState) {
+  std::vector<RingSignatureCheck> signatureChecks;
+  if (!isTransactionValidForPool(cachedTransaction, validatorState, signatureChecks)) {
+    return false;
+  }
+
+  if (verifyRingSignatures(signatureChecks, nullptr) != signatureChecks.size()) {
+    logger(Logging::DEBUGGING) << "Transaction " << cachedTransaction.getTransactionHash()
+      << " is not valid. Reason: " << make_error_code(error::TransactionValidationError::INPUT_INVALID_SIGNATURES).message();
+    return false;
+  }
+
+  return true;
+}
+
+bool Core::isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState,
+                                     std::vector<RingSignatureCheck>& signatureChecks) {
   bool success;
   std::string err;
 
@@ -980,7 +1282,7 @@ bool Core::isTransactionValidForPool(const CachedTransaction& cachedTransaction,
 
   uint64_t fee;
 
-  if (auto validationResult = validateTransaction(cachedTransaction, validatorState, chainsLeaves[0], fee, getTopBlockIndex())) {
+  if (auto validationResult = validateTransaction(cachedTransaction, validatorState, chainsLeaves[0], fee, getTopBlockIndex(), signatureChecks)) {
     logger(Logging::DEBUGGING) << "Transaction " << cachedTransaction.getTransactionHash()
       << " is not valid. Reason: " << validationResult.message();
     return false;
@@ -1301,6 +1603,20 @@ bool Core::extractTransactions(const std::vector<BinaryArray>& rawTransactions,
 
 std::error_code Core::validateTransaction(const CachedTransaction& cachedTransaction, TransactionValidatorState& state,
                                           IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex) {
+  std::vector<RingSignatureCheck> signatureChecks;
+  auto validationResult = validateTransaction(cachedTransaction, state, cache, fee, blockIndex, signatureChecks);
+
+  // The signatures collected before a failed check are still reported first, as when they were checked inline
+  if (verifyRingSignatures(signatureChecks, nullptr) != signatureChecks.size()) {
+    return error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
+  }
+
+  return validationResult;
+}
+
+std::error_code Core::validateTransaction(const CachedTransaction& cachedTransaction, TransactionValidatorState& state,
+                                          IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex,
+                                          std::vector<RingSignatureCheck>& signatureChecks) {
   // TransactionValidatorState currentState;
   const auto& transaction = cachedTransaction.getTransaction();
 auto error = validateSemantic(transaction, fee, blockIndex);
@@ -1321,7 +1637,7 @@ auto error = validateSemantic(transaction, fee, blockIndex);
           return error::TransactionValidationError::INPUT_KEYIMAGE_ALREADY_SPENT;
         }
 
-        std::vector<PublicKey> outputKeys;
+        RingSignatureCheck signatureCheck;
         assert(!in.outputIndexes.empty());
 
         std::vector<uint32_t> globalIndexes(in.outputIndexes.size());
@@ -1330,7 +1646,7 @@ auto error = validateSemantic(transaction, fee, blockIndex);
           globalIndexes[i] = globalIndexes[i - 1] + in.outputIndexes[i];
         }
 
-        auto result = cache->extractKeyOutputKeys(in.amount, blockIndex, {globalIndexes.data(), globalIndexes.size()}, outputKeys);
+        auto result = cache->extractKeyOutputKeys(in.amount, blockIndex, {globalIndexes.data(), globalIndexes.size()}, signatureCheck.outputKeys);
         if (result == ExtractOutputKeysResult::INVALID_GLOBAL_INDEX) {
           return error::TransactionValidationError::INPUT_INVALID_GLOBAL_INDEX;
         }
@@ -1339,14 +1655,12 @@ auto error = validateSemantic(transaction, fee, blockIndex);
           return error::TransactionValidationError::INPUT_SPEND_LOCKED_OUT;
         }
 
-        std::vector<const Crypto::PublicKey*> outputKeyPointers;
-        outputKeyPointers.reserve(outputKeys.size());
-        std::for_each(outputKeys.begin(), outputKeys.end(), [&outputKeyPointers] (const Crypto::PublicKey& key) { outputKeyPointers.push_back(&key); });
-        if (!Crypto::check_ring_signature(cachedTransaction.getTransactionPrefixHash(), in.keyImage, outputKeyPointers.data(),
-                                          outputKeyPointers.size(), transaction.signatures[inputIndex].data(),
-                                          blockIndex > parameters::KEY_IMAGE_CHECKING_BLOCK_INDEX)) {
-          return error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
-        }
+        signatureCheck.transaction = &cachedTransaction;
+        signatureCheck.prefixHash = cachedTransaction.getTransactionPrefixHash();
+        signatureCheck.keyImage = in.keyImage;
+        signatureCheck.signatures = transaction.signatures[inputIndex].data();
+        signatureCheck.checkKeyImage = blockIndex > parameters::KEY_IMAGE_CHECKING_BLOCK_INDEX;
+        signatureChecks.emplace_back(std::move(signatureCheck));
       }
 
     } else {
@@ -1537,12 +1851,19 @@ const Currency& Core::getCurrency() const {
   return currency;
 }
 
+boost::shared_lock<boost::shared_mutex> Core::lockForReading() const {
+  return boost::shared_lock<boost::shared_mutex>(stateMutex);
+}
+
 void Core::save() {
   throwIfNotInitialized();
+  ExclusiveStateLock lock(dispatcher, stateMutex);
 
   deleteAlternativeChains();
   mergeMainChainSegments();
   chainsLeaves[0]->save();
+  mainChainStorage->flush();
+  saveTransactionPool();
 }
 
 void Core::load() {
@@ -1576,6 +1897,10 @@ void Core::load() {
   }
 
   initialized = true;
+
+  loadTransactionPool();
+  contextGroup.spawn(std::bind(&Core::transactionPoolSnapshotProcedure, this));
+  contextGroup.spawn(std::bind(&Core::mainChainStorageFlushProcedure, this));
 }
 
 void Core::initRootSegment() {
@@ -1601,37 +1926,61 @@ void Core::importBlocksFromStorage() {
 
   auto previousBlockHash = getBlockHash(mainChainStorage->getBlockByIndex(commonIndex));
   auto blockCount = mainChainStorage->getBlockCount();
+
+  // Blocks are read from the storage and pushed in order on this thread, everything in between is done
+  // on the worker threads for the next blocks while the current one is pushed
+  const size_t blocksAhead = validationThreadPool.getThreadCount() * IMPORT_BLOCKS_AHEAD_PER_THREAD;
+  std::deque<std::future<std::unique_ptr<ImportedBlock>>> importedBlocks;
+  uint32_t nextBlockToRead = commonIndex + 1;
+
+  auto prepareBlock = [this] (RawBlock& rawBlock) {
+    std::unique_ptr<ImportedBlock> block(new ImportedBlock(std::move(rawBlock)));
+
+    if (!extractTransactions(block->rawBlock.transactions, block->transactions, block->cumulativeSize)) {
+      logger(Logging::ERROR) << "Couldn't deserialize raw block transactions in block " << block->cachedBlock.getBlockHash();
+      throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
+    }
+
+    block->cumulativeSize += getObjectBinarySize(block->blockTemplate.baseTransaction);
+    block->spentOutputs = extractSpentOutputs(block->transactions);
+
+    block->cachedBlock.getBlockHash();
+    for (const auto& transaction : block->transactions) {
+      transaction.getTransactionHash();
+      transaction.getTransactionFee();
+    }
+
+    return block;
+  };
+
   for (uint32_t i = commonIndex + 1; i < blockCount; ++i) {
-    RawBlock rawBlock = mainChainStorage->getBlockByIndex(i);
-    auto blockTemplate = extractBlockTemplate(rawBlock);
-    CachedBlock cachedBlock(blockTemplate);
+    while (nextBlockToRead < blockCount && importedBlocks.size() < blocksAhead) {
+      importedBlocks.push_back(validationThreadPool.addJob(std::bind(prepareBlock, mainChainStorage->getBlockByIndex(nextBlockToRead))));
+      ++nextBlockToRead;
+    }
+
+    std::unique_ptr<ImportedBlock> block = importedBlocks.front().get();
+    importedBlocks.pop_front();
+
+    const CachedBlock& cachedBlock = block->cachedBlock;
 
-    if (blockTemplate.previousBlockHash != previousBlockHash) {
+    if (block->blockTemplate.previousBlockHash != previousBlockHash) {
       logger(Logging::ERROR) << "Corrupted blockchain. Block with index " << i << " and hash " << cachedBlock.getBlockHash()
-                             << " has previous block hash " << blockTemplate.previousBlockHash << ", but parent has hash " << previousBlockHash
+                             << " has previous block hash " << block->blockTemplate.previousBlockHash << ", but parent has hash " << previousBlockHash
                              << ". Resynchronize your daemon please.";
       throw std::system_error(make_error_code(error::CoreErrorCode::CORRUPTED_BLOCKCHAIN));
     }
 
     previousBlockHash = cachedBlock.getBlockHash();
 
-    std::vector<CachedTransaction> transactions;
-    uint64_t cumulativeSize = 0;
-    if (!extractTransactions(rawBlock.transactions, transactions, cumulativeSize)) {
-      logger(Logging::ERROR) << "Couldn't deserialize raw block transactions in block " << cachedBlock.getBlockHash();
-      throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
-    }
-
-    cumulativeSize += getObjectBinarySize(blockTemplate.baseTransaction);
-    TransactionValidatorState spentOutputs = extractSpentOutputs(transactions);
     auto currentDifficulty = chainsLeaves[0]->getDifficultyForNextBlock(i - 1);
 
-    uint64_t cumulativeFee = std::accumulate(transactions.begin(), transactions.end(), UINT64_C(0), [] (uint64_t fee, const CachedTransaction& transaction) {
+    uint64_t cumulativeFee = std::accumulate(block->transactions.begin(), block->transactions.end(), UINT64_C(0), [] (uint64_t fee, const CachedTransaction& transaction) {
       return fee + transaction.getTransactionFee();
     });
 
-    int64_t emissionChange = getEmissionChange(currency, *chainsLeaves[0], i - 1, cachedBlock, cumulativeSize, cumulativeFee);
-    chainsLeaves[0]->pushBlock(cachedBlock, transactions, spentOutputs, cumulativeSize, emissionChange, currentDifficulty, std::move(rawBlock));
+    int64_t emissionChange = getEmissionChange(currency, *chainsLeaves[0], i - 1, cachedBlock, block->cumulativeSize, cumulativeFee);
+    chainsLeaves[0]->pushBlock(cachedBlock, block->transactions, block->spentOutputs, block->cumulativeSize, emissionChange, currentDifficulty, std::move(block->rawBlock));
 
     if (i % 1000 == 0) {
       logger(Logging::INFO) << "Imported block with index " << i << " / " << (blockCount - 1);
@@ -1744,6 +2093,11 @@ std::vector<Crypto::Hash> Core::doBuildSparseChain(const Crypto::Hash& blockHash
 RawBlock Core::getRawBlock(IBlockchainCache* segment, uint32_t blockIndex) const {
   assert(blockIndex >= segment->getStartBlockIndex() && blockIndex <= segment->getTopBlockIndex());
 
+  // The main chain storage mirrors the main chain and decodes blocks straight from its mapped file
+  if (mainChainSet.count(segment) != 0) {
+    return mainChainStorage->getBlockByIndex(blockIndex);
+  }
+
   return segment->getBlockByIndex(blockIndex);
 }
 
@@ -1791,6 +2145,28 @@ size_t Core::pushBlockHashes(uint32_t startIndex, uint32_t fullOffset, size_t ma
   return blockIds.size();
 }
 
+size_t Core::pushBlockHashes(uint32_t startIndex, uint32_t fullOffset, size_t maxItemsCount,
+                             std::vector<BlockFilter>& entries) const {
+  assert(fullOffset >= startIndex);
+
+  uint32_t itemsCount = std::min(fullOffset - startIndex, static_cast<uint32_t>(maxItemsCount));
+  if (itemsCount == 0) {
+    return 0;
+  }
+
+  std::vector<Crypto::Hash> blockIds = getBlockHashes(startIndex, itemsCount);
+
+  entries.reserve(entries.size() + blockIds.size());
+  for (auto& blockHash : blockIds) {
+    BlockFilter entry;
+    entry.blockHash = std::move(blockHash);
+    entry.itemCount = 0;
+    entries.emplace_back(std::move(entry));
+  }
+
+  return blockIds.size();
+}
+
 void Core::fillQueryBlockFullInfo(uint32_t fullOffset, uint32_t currentIndex, size_t maxItemsCount,
                                   std::vector<BlockFullInfo>& entries) const {
   assert(currentIndex >= fullOffset);
@@ -1818,33 +2194,61 @@ void Core::fillQueryBlockShortInfo(uint32_t fullOffset, uint32_t currentIndex, s
   entries.reserve(entries.size() + fullBlocksCount);
 
   for (uint32_t blockIndex = fullOffset; blockIndex < fullOffset + fullBlocksCount; ++blockIndex) {
-    IBlockchainCache* segment = findMainChainSegmentContainingBlock(blockIndex);
-    RawBlock rawBlock = getRawBlock(segment, blockIndex);
-
-    BlockShortInfo blockShortInfo;
-    blockShortInfo.block = std::move(rawBlock.block);
-    blockShortInfo.blockId = segment->getBlockHash(blockIndex);
-
-    blockShortInfo.txPrefixes.reserve(rawBlock.transactions.size());
-    for (auto& rawTransaction : rawBlock.transactions) {
-      TransactionPrefixInfo prefixInfo;
-      prefixInfo.txHash =
-          getBinaryArrayHash(rawTransaction); // TODO: is there faster way to get hash without calculation?
-
-      Transaction transaction;
-      if (!fromBinaryArray(transaction, rawTransaction)) {
-        // TODO: log it
-        throw std::runtime_error("Couldn't deserialize transaction");
-      }
+    entries.emplace_back(getBlockShortInfo(blockIndex));
+  }
+}
 
-      prefixInfo.txPrefix = std::move(static_cast<TransactionPrefix&>(transaction));
-      blockShortInfo.txPrefixes.emplace_back(std::move(prefixInfo));
+void Core::fillQueryBlockFilters(uint32_t fullOffset, uint32_t currentIndex, size_t maxItemsCount,
+                                 std::vector<BlockFilter>& entries) const {
+  assert(currentIndex >= fullOffset);
+
+  uint32_t filtersCount = static_cast<uint32_t>(std::min(static_cast<uint32_t>(maxItemsCount), currentIndex - fullOffset + 1));
+  entries.reserve(entries.size() + filtersCount);
+
+  for (uint32_t blockIndex = fullOffset; blockIndex < fullOffset + filtersCount; ++blockIndex) {
+    BlockFilter blockFilter;
+    if (!blockFiltersCache.get(blockIndex, blockFilter)) {
+      blockFilter = makeBlockFilter(getBlockShortInfo(blockIndex));
+      blockFiltersCache.put(blockIndex, blockFilter);
     }
 
-    entries.emplace_back(std::move(blockShortInfo));
+    entries.emplace_back(std::move(blockFilter));
   }
 }
 
+BlockShortInfo Core::getBlockShortInfo(uint32_t blockIndex) const {
+  BlockShortInfo blockShortInfo;
+  if (liteBlocksCache.get(blockIndex, blockShortInfo)) {
+    return blockShortInfo;
+  }
+
+  IBlockchainCache* segment = findMainChainSegmentContainingBlock(blockIndex);
+  RawBlock rawBlock = getRawBlock(segment, blockIndex);
+
+  blockShortInfo.block = std::move(rawBlock.block);
+  blockShortInfo.blockId = segment->getBlockHash(blockIndex);
+
+  blockShortInfo.txPrefixes.reserve(rawBlock.transactions.size());
+  for (auto& rawTransaction : rawBlock.transactions) {
+    TransactionPrefixInfo prefixInfo;
+    prefixInfo.txHash =
+        getBinaryArrayHash(rawTransaction); // TODO: is there faster way to get hash without calculation?
+
+    Transaction transaction;
+    if (!fromBinaryArray(transaction, rawTransaction)) {
+      // TODO: log it
+      throw std::runtime_error("Couldn't deserialize transaction");
+    }
+
+    prefixInfo.txPrefix = std::move(static_cast<TransactionPrefix&>(transaction));
+    blockShortInfo.txPrefixes.emplace_back(std::move(prefixInfo));
+  }
+
+  liteBlocksCache.put(blockIndex, blockShortInfo);
+
+  return blockShortInfo;
+}
+
 void Core::getTransactionPoolDifference(const std::vector<Crypto::Hash>& knownHashes,
                                         std::vector<Crypto::Hash>& newTransactions,
                                         std::vector<Crypto::Hash>& deletedTransactions) const {
@@ -1889,46 +2293,76 @@ size_t Core::calculateCumulativeBlocksizeLimit(uint32_t height) const {
 
 void Core::fillBlockTemplate(BlockTemplate& block, size_t medianSize, size_t maxCumulativeSize,
                              size_t& transactionsSize, uint64_t& fee) const {
-  transactionsSize = 0;
-  fee = 0;
+  std::lock_guard<std::mutex> lock(blockTemplateMutex);
+
+  // New blocks reach the selection through the pool, as they remove the transactions they include from it
+  uint64_t poolVersion = transactionPool->getVersion();
+  if (!blockTemplateTransactions || blockTemplateTransactions->poolVersion != poolVersion ||
+      blockTemplateTransactions->medianSize != medianSize || blockTemplateTransactions->maxCumulativeSize != maxCumulativeSize) {
+    blockTemplateTransactions = selectBlockTemplateTransactions(medianSize, maxCumulativeSize);
+    blockTemplateTransactions->poolVersion = poolVersion;
+  } else {
+    logger(Logging::TRACE) << "Reusing block template transactions for pool version " << poolVersion;
+  }
+
+  block.transactionHashes.insert(block.transactionHashes.end(), blockTemplateTransactions->transactionHashes.begin(),
+                                 blockTemplateTransactions->transactionHashes.end());
+  transactionsSize = blockTemplateTransactions->transactionsSize;
+  fee = blockTemplateTransactions->fee;
+}
+
+Core::BlockTemplateTransactions Core::selectBlockTemplateTransactions(size_t medianSize, size_t maxCumulativeSize) const {
+  BlockTemplateTransactions selection;
+  selection.medianSize = medianSize;
+  selection.maxCumulativeSize = maxCumulativeSize;
+  selection.transactionsSize = 0;
+  selection.fee = 0;
 
   size_t maxTotalSize = (125 * medianSize) / 100;
   maxTotalSize = std::min(maxTotalSize, maxCumulativeSize) - currency.minerTxBlobReservedSize();
 
-  TransactionSpentInputsChecker spentInputsChecker;
+  /* The pool never holds two transactions spending the same key image, so the transactions are walked
+     in place in fee order and only need checking against the size limits. Fusion transactions sort
+     last, the first pass takes as many of them as fit from the end */
+  std::vector<Crypto::Hash> poolTransactionHashes = transactionPool->getTransactionHashes();
+  std::unordered_set<Crypto::Hash> fusionTransactions;
 
-  std::vector<CachedTransaction> poolTransactions = transactionPool->getPoolTransactions();
-  for (auto it = poolTransactions.rbegin(); it != poolTransactions.rend() && it->getTransactionFee() == 0; ++it) {
-    const CachedTransaction& transaction = *it;
+  for (auto it = poolTransactionHashes.rbegin(); it != poolTransactionHashes.rend(); ++it) {
+    const CachedTransaction& transaction = transactionPool->getTransaction(*it);
+    if (transaction.getTransactionFee() != 0) {
+      break;
+    }
 
     auto transactionBlobSize = transaction.getTransactionBinaryArray().size();
-    if (currency.fusionTxMaxSize() < transactionsSize + transactionBlobSize) {
+    if (currency.fusionTxMaxSize() < selection.transactionsSize + transactionBlobSize) {
       continue;
     }
 
-    if (!spentInputsChecker.haveSpentInputs(transaction.getTransaction())) {
-      block.transactionHashes.emplace_back(transaction.getTransactionHash());
-      transactionsSize += transactionBlobSize;
-      logger(Logging::TRACE) << "Fusion transaction " << transaction.getTransactionHash() << " included to block template";
-    }
+    selection.transactionHashes.emplace_back(transaction.getTransactionHash());
+    selection.transactionsSize += transactionBlobSize;
+    fusionTransactions.insert(transaction.getTransactionHash());
+    logger(Logging::TRACE) << "Fusion transaction " << transaction.getTransactionHash() << " included to block template";
   }
 
-  for (const auto& cachedTransaction : poolTransactions) {
+  for (const auto& transactionHash : poolTransactionHashes) {
+    if (fusionTransactions.count(transactionHash) != 0) {
+      continue;
+    }
+
+    const CachedTransaction& cachedTransaction = transactionPool->getTransaction(transactionHash);
     size_t blockSizeLimit = (cachedTransaction.getTransactionFee() == 0) ? medianSize : maxTotalSize;
 
-    if (blockSizeLimit < transactionsSize + cachedTransaction.getTransactionBinaryArray().size()) {
+    if (blockSizeLimit < selection.transactionsSize + cachedTransaction.getTransactionBinaryArray().size()) {
       continue;
     }
 
-    if (!spentInputsChecker.haveSpentInputs(cachedTransaction.getTransaction())) {
-      transactionsSize += cachedTransaction.getTransactionBinaryArray().size();
-      fee += cachedTransaction.getTransactionFee();
-      block.transactionHashes.emplace_back(cachedTransaction.getTransactionHash());
-      logger(Logging::TRACE) << "Transaction " << cachedTransaction.getTransactionHash() << " included to block template";
-    } else {
-      logger(Logging::TRACE) << "Transaction " << cachedTransaction.getTransactionHash() << " is failed to include to block template";
-    }
+    selection.transactionsSize += cachedTransaction.getTransactionBinaryArray().size();
+    selection.fee += cachedTransaction.getTransactionFee();
+    selection.transactionHashes.emplace_back(transactionHash);
+    logger(Logging::TRACE) << "Transaction " << transactionHash << " included to block template";
   }
+
+  return selection;
 }
 
 void Core::deleteAlternativeChains() {
@@ -2362,6 +2796,7 @@ void Core::transactionPoolCleaningProcedure() {
     for (;;) {
       timer.sleep(OUTDATED_TRANSACTION_POLLING_INTERVAL);
 
+      ExclusiveStateLock lock(dispatcher, stateMutex);
       auto deletedTransactions = transactionPool->clean(getTopBlockIndex());
       notifyObservers(makeDelTransactionMessage(std::move(deletedTransactions), Messages::DeleteTransaction::Reason::Outdated));
     }
@@ -2372,6 +2807,122 @@ void Core::transactionPoolCleaningProcedure() {
   }
 }
 
+void Core::transactionPoolSnapshotProcedure() {
+  System::Timer timer(dispatcher);
+
+  try {
+    for (;;) {
+      timer.sleep(TRANSACTION_POOL_SNAPSHOT_INTERVAL);
+      saveTransactionPool();
+    }
+  } catch (System::InterruptedException&) {
+    logger(Logging::DEBUGGING) << "transactionPoolSnapshotProcedure has been interrupted";
+  } catch (std::exception& e) {
+    logger(Logging::ERROR) << "Error occurred while saving transactions pool: " << e.what();
+  }
+}
+
+void Core::mainChainStorageFlushProcedure() {
+  System::Timer timer(dispatcher);
+
+  try {
+    for (;;) {
+      timer.sleep(MAIN_CHAIN_STORAGE_FLUSH_INTERVAL);
+      mainChainStorage->flush();
+    }
+  } catch (System::InterruptedException&) {
+    logger(Logging::DEBUGGING) << "mainChainStorageFlushProcedure has been interrupted";
+  } catch (std::exception& e) {
+    logger(Logging::ERROR) << "Error occurred while flushing main chain storage: " << e.what();
+  }
+}
+
+void Core::saveTransactionPool() {
+  if (dataFolder.empty()) {
+    return;
+  }
+
+  PoolSnapshot snapshot;
+  snapshot.version = TRANSACTION_POOL_SNAPSHOT_VERSION;
+
+  auto transactionHashes = transactionPool->getTransactionHashes();
+  snapshot.transactions.reserve(transactionHashes.size());
+  for (const auto& transactionHash : transactionHashes) {
+    snapshot.transactions.push_back(PoolSnapshotEntry{transactionPool->getTransactionReceiveTime(transactionHash),
+                                                      transactionPool->getTransaction(transactionHash).getTransaction()});
+  }
+
+  // Written next to the old snapshot first, so a crash halfway through never leaves a truncated file behind
+  std::string fileName = dataFolder + "/" + currency.txPoolFileName();
+  std::string temporaryFileName = fileName + ".tmp";
+  if (!Common::saveStringToFile(temporaryFileName, Common::asString(toBinaryArray(snapshot))) ||
+      std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0) {
+    logger(Logging::WARNING) << "Failed to save transaction pool to " << fileName;
+    return;
+  }
+
+  logger(Logging::DEBUGGING) << "Saved " << snapshot.transactions.size() << " pool transactions to " << fileName;
+}
+
+void Core::loadTransactionPool() {
+  if (dataFolder.empty()) {
+    return;
+  }
+
+  std::string fileName = dataFolder + "/" + currency.txPoolFileName();
+  std::string data;
+  if (!Common::loadFileToString(fileName, data)) {
+    return;
+  }
+
+  PoolSnapshot snapshot;
+  if (!fromBinaryArray(snapshot, Common::asBinaryArray(data)) || snapshot.version != TRANSACTION_POOL_SNAPSHOT_VERSION) {
+    logger(Logging::WARNING) << "Couldn't read transaction pool from " << fileName << ", starting with an empty pool";
+    return;
+  }
+
+  /* The snapshot isn't trusted: every transaction is checked against the chain again, which also rebuilds
+     its spent key images. The ring signatures of all of them are then verified on the validation threads
+     at once instead of one transaction after another */
+  std::vector<RestoredPoolTransaction> restoredTransactions;
+  restoredTransactions.reserve(snapshot.transactions.size());
+  for (auto& entry : snapshot.transactions) {
+    restoredTransactions.emplace_back(std::move(entry.transaction), entry.receiveTime);
+
+    auto& restored = restoredTransactions.back();
+    if (!isTransactionValidForPool(restored.cachedTransaction, restored.validatorState, restored.signatureChecks)) {
+      restoredTransactions.pop_back();
+    }
+  }
+
+  std::vector<std::future<bool>> signaturesValid;
+  signaturesValid.reserve(restoredTransactions.size());
+  for (const auto& restored : restoredTransactions) {
+    signaturesValid.push_back(validationThreadPool.addJob([&restored] {
+      return verifyRingSignatures(restored.signatureChecks, nullptr) == restored.signatureChecks.size();
+    }));
+  }
+
+  std::vector<Crypto::Hash> restoredHashes;
+  for (size_t i = 0; i < restoredTransactions.size(); ++i) {
+    if (!signaturesValid[i].get()) {
+      continue;
+    }
+
+    auto& restored = restoredTransactions[i];
+    auto transactionHash = restored.cachedTransaction.getTransactionHash();
+    if (transactionPool->pushTransaction(std::move(restored.cachedTransaction), std::move(restored.validatorState), restored.receiveTime)) {
+      restoredHashes.push_back(transactionHash);
+    }
+  }
+
+  logger(Logging::INFO) << "Restored " << restoredHashes.size() << " of " << snapshot.transactions.size() << " pool transactions from " << fileName;
+
+  if (!restoredHashes.empty()) {
+    notifyObservers(makeAddTransactionMessage(std::move(restoredHashes)));
+  }
+}
+
 void Core::updateBlockMedianSize() {
   auto mainChain = chainsLeaves[0];
 
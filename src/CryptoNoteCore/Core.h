@@ -6,12 +6,14 @@
 
 #pragma once
 #include <ctime>
+#include <mutex>
 #include <vector>
 #include <unordered_map>
 #include "BlockchainCache.h"
 #include "BlockchainMessages.h"
 #include "CachedBlock.h"
 #include "CachedTransaction.h"
+#include "Common/LruCache.h"
 #include "Currency.h"
 #include "Checkpoints.h"
 #include "IBlockchainCache.h"
@@ -24,17 +26,23 @@
 #include "IUpgradeManager.h"
 #include <Logging/LoggerMessage.h>
 #include "MessageQueue.h"
+#include "RingSignatureVerifier.h"
 #include "TransactionValidatiorState.h"
 #include "SwappedVector.h"
 
 #include <System/ContextGroup.h>
 
+#include <boost/optional.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
 namespace CryptoNote {
 
 class Core : public ICore, public ICoreInformation {
 public:
   Core(const Currency& currency, Logging::ILogger& logger, Checkpoints&& checkpoints, System::Dispatcher& dispatcher,
-       std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainChainStorage);
+       std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainChainStorage,
+       const std::string& dataFolder);
   virtual ~Core();
 
   virtual bool addMessageQueue(MessageQueue<BlockchainMessage>&  messageQueue) override;
@@ -59,6 +67,9 @@ public:
     uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockFullInfo>& entries) const override;
   virtual bool queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp,
     uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockShortInfo>& entries) const override;
+  virtual bool queryBlockFilters(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp,
+    uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset, std::vector<BlockFilter>& entries) const override;
+  virtual bool getBlocksLite(const std::vector<Crypto::Hash>& blockHashes, std::vector<BlockShortInfo>& entries) const override;
 
   virtual bool hasTransaction(const Crypto::Hash& transactionHash) const override;
   virtual void getTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<BinaryArray>& transactions, std::vector<Crypto::Hash>& missedHashes) const override;
@@ -66,6 +77,8 @@ public:
   virtual uint64_t getBlockDifficulty(uint32_t blockIndex) const override;
   virtual uint64_t getDifficultyForNextBlock() const override;
 
+  virtual void precalculateBlockLongHashes(const std::vector<CachedBlock>& blocks) override;
+  virtual Common::ThreadPool& getValidationThreadPool() override;
   virtual std::error_code addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlock) override;
   virtual std::error_code addBlock(RawBlock&& rawBlock) override;
 
@@ -98,6 +111,11 @@ public:
 
   const Currency& getCurrency() const;
 
+  /* Chain and pool changes are made under the exclusive side of this lock, so
+     other threads can read a consistent state of the core while holding it. The
+     core's own thread doesn't need it to read */
+  boost::shared_lock<boost::shared_mutex> lockForReading() const;
+
   virtual void save() override;
   virtual void load() override;
 
@@ -127,8 +145,28 @@ private:
   IntrusiveLinkedList<MessageQueue<BlockchainMessage>> queueList;
   std::unique_ptr<IBlockchainCacheFactory> blockchainCacheFactory;
   std::unique_ptr<IMainChainStorage> mainChainStorage;
+  Common::ThreadPool validationThreadPool;
+  mutable boost::shared_mutex stateMutex;
   bool initialized;
 
+  // main chain lite blocks by block index, entries above a switched chain's split are dropped
+  mutable Common::ShardedLruCache<uint32_t, BlockShortInfo> liteBlocksCache;
+  // main chain block filters by block index, dropped together with the lite blocks
+  mutable Common::ShardedLruCache<uint32_t, BlockFilter> blockFiltersCache;
+
+  // Pool transactions picked for the last block template, reused while the pool and the size limits stay the same
+  struct BlockTemplateTransactions {
+    uint64_t poolVersion;
+    size_t medianSize;
+    size_t maxCumulativeSize;
+    std::vector<Crypto::Hash> transactionHashes;
+    size_t transactionsSize;
+    uint64_t fee;
+  };
+
+  mutable std::mutex blockTemplateMutex;
+  mutable boost::optional<BlockTemplateTransactions> blockTemplateTransactions;
+
   time_t start_time;
 
   size_t blockMedianSize;
@@ -138,6 +176,8 @@ private:
 
   std::error_code validateSemantic(const Transaction& transaction, uint64_t& fee, uint32_t blockIndex);
   std::error_code validateTransaction(const CachedTransaction& transaction, TransactionValidatorState& state, IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex);
+  std::error_code validateTransaction(const CachedTransaction& transaction, TransactionValidatorState& state, IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex,
+    std::vector<RingSignatureCheck>& signatureChecks);
 
   uint32_t findBlockchainSupplement(const std::vector<Crypto::Hash>& remoteBlockIds) const;
   std::vector<Crypto::Hash> getBlockHashes(uint32_t startBlockIndex, uint32_t maxCount) const;
@@ -163,15 +203,20 @@ private:
 
   size_t pushBlockHashes(uint32_t startIndex, uint32_t fullOffset, size_t maxItemsCount, std::vector<BlockShortInfo>& entries) const;
   size_t pushBlockHashes(uint32_t startIndex, uint32_t fullOffset, size_t maxItemsCount, std::vector<BlockFullInfo>& entries) const;
+  size_t pushBlockHashes(uint32_t startIndex, uint32_t fullOffset, size_t maxItemsCount, std::vector<BlockFilter>& entries) const;
   bool notifyObservers(BlockchainMessage&& msg);
   void fillQueryBlockFullInfo(uint32_t fullOffset, uint32_t currentIndex, size_t maxItemsCount, std::vector<BlockFullInfo>& entries) const;
   void fillQueryBlockShortInfo(uint32_t fullOffset, uint32_t currentIndex, size_t maxItemsCount, std::vector<BlockShortInfo>& entries) const;
+  void fillQueryBlockFilters(uint32_t fullOffset, uint32_t currentIndex, size_t maxItemsCount, std::vector<BlockFilter>& entries) const;
+  uint32_t findQueryFullOffset(uint32_t startIndex, uint64_t timestamp) const;
+  BlockShortInfo getBlockShortInfo(uint32_t blockIndex) const;
 
   void getTransactionPoolDifference(const std::vector<Crypto::Hash>& knownHashes, std::vector<Crypto::Hash>& newTransactions, std::vector<Crypto::Hash>& deletedTransactions) const;
 
   uint8_t getBlockMajorVersionForHeight(uint32_t height) const;
   size_t calculateCumulativeBlocksizeLimit(uint32_t height) const;
   void fillBlockTemplate(BlockTemplate& block, size_t medianSize, size_t maxCumulativeSize, size_t& transactionsSize, uint64_t& fee) const;
+  BlockTemplateTransactions selectBlockTemplateTransactions(size_t medianSize, size_t maxCumulativeSize) const;
   void deleteAlternativeChains();
   void deleteLeaf(size_t leafIndex);
   void mergeMainChainSegments();
@@ -185,15 +230,22 @@ private:
   void actualizePoolTransactionsLite(const TransactionValidatorState& validatorState); //Checks pool txs only for double spend.
 
   void transactionPoolCleaningProcedure();
+  void transactionPoolSnapshotProcedure();
+  void mainChainStorageFlushProcedure();
+  void saveTransactionPool();
+  void loadTransactionPool();
   void updateBlockMedianSize();
   bool addTransactionToPool(CachedTransaction&& cachedTransaction);
+  bool doAddTransactionToPool(const BinaryArray& transactionBinaryArray);
   bool isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState);
+  bool isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState,
+    std::vector<RingSignatureCheck>& signatureChecks);
 
   void initRootSegment();
   void importBlocksFromStorage();
   void cutSegment(IBlockchainCache& segment, uint32_t startIndex);
 
-  void switchMainChainStorage(uint32_t splitBlockIndex, IBlockchainCache& newChain);
+  void switchMainChainStorage(IBlockchainCache& newChain);
 };
 
 }
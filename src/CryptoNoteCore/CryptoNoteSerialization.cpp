@@ -127,6 +127,12 @@ bool serializeVarintVector(std::vector<uint32_t>& vector, CryptoNote::ISerialize
   return true;
 }
 
+/* KV-binary and JSON objects keep one value per name, so transactions after the first
+   get the index appended. The first keeps the plain names older nodes read */
+std::string transactionMemberName(const char* name, size_t index) {
+  return index == 0 ? std::string(name) : std::string(name) + "_" + std::to_string(index);
+}
+
 }
 
 namespace Crypto {
@@ -455,20 +461,22 @@ void serialize(RawBlock& rawBlock, ISerializer& serializer) {
     serializer(txCount, "tx_count");
     rawBlock.transactions.resize(static_cast<size_t>(txCount));
 
-    for (auto& txBlob : rawBlock.transactions) {
+    for (size_t i = 0; i < rawBlock.transactions.size(); ++i) {
+      auto& txBlob = rawBlock.transactions[i];
       uint64_t txSize;
-      serializer(txSize, "tx_size");
+      serializer(txSize, transactionMemberName("tx_size", i));
       txBlob.resize(txSize);
-      serializer.binary(txBlob.data(), txBlob.size(), "transaction");
+      serializer.binary(txBlob.data(), txBlob.size(), transactionMemberName("transaction", i));
     }
   } else {
     auto txCount = rawBlock.transactions.size();
     serializer(txCount, "tx_count");
 
-    for (auto& txBlob : rawBlock.transactions) {
+    for (size_t i = 0; i < rawBlock.transactions.size(); ++i) {
+      auto& txBlob = rawBlock.transactions[i];
       auto txSize = txBlob.size();
-      serializer(txSize, "tx_size");
-      serializer.binary(txBlob.data(), txBlob.size(), "transaction");
+      serializer(txSize, transactionMemberName("tx_size", i));
+      serializer.binary(txBlob.data(), txBlob.size(), transactionMemberName("transaction", i));
     }
   }
 }
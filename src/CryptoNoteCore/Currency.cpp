@@ -70,6 +70,8 @@ bool Currency::init() {
     m_upgradeHeightV3 = static_cast<uint32_t>(-1);
     m_blocksFileName = "testnet_" + m_blocksFileName;
     m_blockIndexesFileName = "testnet_" + m_blockIndexesFileName;
+    m_blocksDataFileName = "testnet_" + m_blocksDataFileName;
+    m_blockOffsetsFileName = "testnet_" + m_blockOffsetsFileName;
     m_txPoolFileName = "testnet_" + m_txPoolFileName;
   }
 
@@ -697,6 +699,8 @@ m_upgradeVotingWindow(currency.m_upgradeVotingWindow),
 m_upgradeWindow(currency.m_upgradeWindow),
 m_blocksFileName(currency.m_blocksFileName),
 m_blockIndexesFileName(currency.m_blockIndexesFileName),
+m_blocksDataFileName(currency.m_blocksDataFileName),
+m_blockOffsetsFileName(currency.m_blockOffsetsFileName),
 m_txPoolFileName(currency.m_txPoolFileName),
 m_genesisBlockReward(currency.m_genesisBlockReward),
 m_zawyDifficultyBlockIndex(currency.m_zawyDifficultyBlockIndex),
@@ -764,6 +768,8 @@ zawyDifficultyBlockVersion(parameters::ZAWY_DIFFICULTY_DIFFICULTY_BLOCK_VERSION)
 
   blocksFileName(parameters::CRYPTONOTE_BLOCKS_FILENAME);
   blockIndexesFileName(parameters::CRYPTONOTE_BLOCKINDEXES_FILENAME);
+  blocksDataFileName(parameters::CRYPTONOTE_BLOCKS_DATA_FILENAME);
+  blockOffsetsFileName(parameters::CRYPTONOTE_BLOCK_OFFSETS_FILENAME);
   txPoolFileName(parameters::CRYPTONOTE_POOLDATA_FILENAME);
 
     isBlockexplorer(false);
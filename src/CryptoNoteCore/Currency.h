@@ -124,6 +124,8 @@ public:
 
   const std::string& blocksFileName() const { return m_blocksFileName; }
   const std::string& blockIndexesFileName() const { return m_blockIndexesFileName; }
+  const std::string& blocksDataFileName() const { return m_blocksDataFileName; }
+  const std::string& blockOffsetsFileName() const { return m_blockOffsetsFileName; }
   const std::string& txPoolFileName() const { return m_txPoolFileName; }
 
   bool isBlockexplorer() const { return m_isBlockexplorer; }
@@ -230,6 +232,8 @@ private:
 
   std::string m_blocksFileName;
   std::string m_blockIndexesFileName;
+  std::string m_blocksDataFileName;
+  std::string m_blockOffsetsFileName;
   std::string m_txPoolFileName;
 
   static const std::vector<uint64_t> PRETTY_AMOUNTS;
@@ -314,6 +318,8 @@ public:
 
   CurrencyBuilder& blocksFileName(const std::string& val) { m_currency.m_blocksFileName = val; return *this; }
   CurrencyBuilder& blockIndexesFileName(const std::string& val) { m_currency.m_blockIndexesFileName = val; return *this; }
+  CurrencyBuilder& blocksDataFileName(const std::string& val) { m_currency.m_blocksDataFileName = val; return *this; }
+  CurrencyBuilder& blockOffsetsFileName(const std::string& val) { m_currency.m_blockOffsetsFileName = val; return *this; }
   CurrencyBuilder& txPoolFileName(const std::string& val) { m_currency.m_txPoolFileName = val; return *this; }
   
   CurrencyBuilder& isBlockexplorer(const bool val) { m_currency.m_isBlockexplorer = val; return *this; }
@@ -17,6 +17,10 @@
 
 #include "DBUtils.h"
 
+#include <cstring>
+
+#include "Serialization/KVBinaryCommon.h"
+
 namespace {
   const std::string RAW_BLOCK_NAME = "raw_block";
   const std::string RAW_TXS_NAME = "raw_txs";
@@ -35,6 +39,29 @@ namespace DB {
     return ss.str();
   }
 
+  std::string getKeyPrefix(const std::string& rawKey) {
+    // Serialized keys hold the storage header and the root element count, then the
+    // root element, which is named after the key prefix
+    const size_t nameOffset = sizeof(KVBinaryStorageBlockHeader) + 1;
+    if (rawKey.size() <= nameOffset) {
+      return std::string();
+    }
+
+    KVBinaryStorageBlockHeader header;
+    std::memcpy(&header, rawKey.data(), sizeof(header));
+    if (header.m_signature_a != PORTABLE_STORAGE_SIGNATUREA || header.m_signature_b != PORTABLE_STORAGE_SIGNATUREB ||
+        header.m_ver != PORTABLE_STORAGE_FORMAT_VER) {
+      return std::string();
+    }
+
+    size_t nameLength = static_cast<uint8_t>(rawKey[nameOffset]);
+    if (rawKey.size() < nameOffset + 1 + nameLength) {
+      return std::string();
+    }
+
+    return rawKey.substr(nameOffset + 1, nameLength);
+  }
+
   void deserialize(const std::string& serialized, RawBlock& value, const std::string& name) {
     std::stringstream ss(serialized);
     Common::StdInputStream stream(ss);
@@ -75,6 +75,9 @@ namespace DB {
 
   std::string serialize(const RawBlock& value, const std::string& name);
 
+  // The prefix a raw key was serialized with by serializeKey, or an empty string for keys written some other way
+  std::string getKeyPrefix(const std::string& rawKey);
+
   template <class Key, class Value>
   std::pair<std::string, std::string> serialize(const std::string& keyPrefix, const Key& key, const Value& value) {
     return{ DB::serialize(std::make_pair(keyPrefix, key), keyPrefix), DB::serialize(value, keyPrefix) };
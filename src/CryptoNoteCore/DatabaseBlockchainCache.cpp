@@ -415,7 +415,56 @@ private:
   uint32_t schemeVersion;
 };
 
-const uint32_t CURRENT_DB_SCHEME_VERSION = 2;
+const uint32_t CURRENT_DB_SCHEME_VERSION = 3;
+
+const std::string SPENT_KEY_IMAGES_FILTER_KEY = "spent_key_images_filter";
+
+// Blocks read at once while building the spent key images filter from the database
+const uint32_t SPENT_KEY_IMAGES_FILTER_BUILD_BATCH = 1000;
+
+class SpentKeyImagesFilterReadBatch: public IReadBatch {
+public:
+  virtual ~SpentKeyImagesFilterReadBatch() {}
+
+  virtual std::vector<std::string> getRawKeys() const override {
+    return {SPENT_KEY_IMAGES_FILTER_KEY};
+  }
+
+  virtual void submitRawResult(const std::vector<std::string>& values, const std::vector<bool>& resultStates) override {
+    assert(values.size() == 1);
+    assert(resultStates.size() == values.size());
+
+    if (!resultStates[0]) {
+      return;
+    }
+
+    filter = values[0];
+  }
+
+  boost::optional<std::string> getFilter() {
+    return filter;
+  }
+
+private:
+  boost::optional<std::string> filter;
+};
+
+class SpentKeyImagesFilterWriteBatch: public IWriteBatch {
+public:
+  SpentKeyImagesFilterWriteBatch(std::string&& filter): filter(std::move(filter)) {}
+  virtual ~SpentKeyImagesFilterWriteBatch() {}
+
+  virtual std::vector<std::pair<std::string, std::string> > extractRawDataToInsert() override {
+    return {make_pair(SPENT_KEY_IMAGES_FILTER_KEY, std::move(filter))};
+  }
+
+  virtual std::vector<std::string> extractRawKeysToRemove() override {
+    return {};
+  }
+
+private:
+  std::string filter;
+};
 
 }
 
@@ -575,13 +624,19 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
 
   cutTail(unitsCache, currentTop + 1 - splitBlockIndex);
 
+  // Key images of the removed blocks stay in the spent key images filter, which only
+  // makes checkIfSpent confirm them against the database
+
   children.push_back(cache.get());
   logger(Logging::TRACE) << "Delete successfull";
 
-  // invalidate top block index and hash
+  // invalidate top block index and hash, and read them back while the split still has
+  // the cache to itself, so readers on other threads never fill them concurrently
   topBlockIndex = boost::none;
   topBlockHash = boost::none;
   transactionsCount = boost::none;
+  getTopBlockHash();
+  getCachedTransactionsCount();
 
   logger(Logging::DEBUGGING) << "split completed";
   // return new cache
@@ -704,6 +759,7 @@ void DatabaseBlockchainCache::requestDeleteKeyOutputsAmount(BlockchainWriteBatch
   writeBatch.removeKeyOutputGlobalIndexes(amount, outputsCount - boundary, boundary);
   for (GlobalOutputIndex index = boundary; index < outputsCount; ++index) {
     writeBatch.removeKeyOutputInfo(amount, index);
+    keyOutputsCache.erase(std::make_pair(amount, index));
   }
 
   updateKeyOutputCount(amount, boundary - outputsCount);
@@ -781,6 +837,7 @@ void DatabaseBlockchainCache::pushTransaction(const CachedTransaction& cachedTra
       outputInfo.outputIndex = poi.outputIndex;
 
       batch.insertKeyOutputInfo(output.amount, globalIndex, outputInfo);
+      keyOutputsCache.put(std::make_pair(output.amount, globalIndex), outputInfo);
     }
   }
 
@@ -927,6 +984,10 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
   topBlockHash = cachedBlock.getBlockHash();
   logger(Logging::DEBUGGING) << "push block " << cachedBlock.getBlockHash() << " completed";
 
+  for (const auto& keyImage: validatorState.spentKeyImages) {
+    spentKeyImagesFilter.add(keyImage);
+  }
+
   unitsCache.push_back(blockInfo);
   if (unitsCache.size() > unitsCacheSize) {
     unitsCache.pop_front();
@@ -938,6 +999,10 @@ PushedBlockInfo DatabaseBlockchainCache::getPushedBlockInfo(uint32_t blockIndex)
 }
 
 bool DatabaseBlockchainCache::checkIfSpent(const Crypto::KeyImage& keyImage, uint32_t blockIndex) const {
+  if (spentKeyImagesFilterLoaded && !spentKeyImagesFilter.mayContain(keyImage)) {
+    return false;
+  }
+
   auto batch = BlockchainReadBatch().requestBlockIndexBySpentKeyImage(keyImage);
   auto res = database.read(batch);
   if (res) {
@@ -1400,10 +1465,68 @@ size_t DatabaseBlockchainCache::getChildCount() const {
   return children.size();
 }
 
+/*
+ * The spent key images filter is stored together with the hash of the top block it was saved at,
+ * and is only used again if the database still ends with that block. Otherwise it is rebuilt
+ */
 void DatabaseBlockchainCache::save() {
+  if (!spentKeyImagesFilterLoaded) {
+    return;
+  }
+
+  const Crypto::Hash& topHash = getTopBlockHash();
+  std::string filter(reinterpret_cast<const char*>(topHash.data), sizeof(topHash.data));
+  filter += spentKeyImagesFilter.toBinary();
+
+  SpentKeyImagesFilterWriteBatch writeBatch(std::move(filter));
+  auto ec = database.write(writeBatch);
+  if (ec) {
+    logger(Logging::ERROR) << "Couldn't save spent key images filter: " << ec.message();
+  }
 }
 
 void DatabaseBlockchainCache::load() {
+  SpentKeyImagesFilterReadBatch readBatch;
+  auto ec = database.read(readBatch);
+  if (ec) {
+    throw std::system_error(ec);
+  }
+
+  auto filter = readBatch.getFilter();
+  const Crypto::Hash& topHash = getTopBlockHash();
+  // filled now so that concurrent readers only ever see it set
+  getCachedTransactionsCount();
+
+  if (filter && filter->size() > sizeof(topHash.data) && filter->compare(0, sizeof(topHash.data), reinterpret_cast<const char*>(topHash.data), sizeof(topHash.data)) == 0 &&
+      spentKeyImagesFilter.fromBinary(filter->substr(sizeof(topHash.data)))) {
+    logger(Logging::DEBUGGING) << "Spent key images filter loaded";
+  } else {
+    logger(Logging::INFO) << "Building spent key images filter";
+    buildSpentKeyImagesFilter();
+  }
+
+  spentKeyImagesFilterLoaded = true;
+}
+
+void DatabaseBlockchainCache::buildSpentKeyImagesFilter() {
+  spentKeyImagesFilter.clear();
+
+  uint32_t topIndex = getTopBlockIndex();
+  for (uint32_t startIndex = 0; startIndex <= topIndex; startIndex += SPENT_KEY_IMAGES_FILTER_BUILD_BATCH) {
+    uint32_t endIndex = std::min(topIndex, startIndex + SPENT_KEY_IMAGES_FILTER_BUILD_BATCH - 1);
+
+    BlockchainReadBatch batch;
+    for (uint32_t blockIndex = startIndex; blockIndex <= endIndex; ++blockIndex) {
+      batch.requestSpentKeyImagesByBlock(blockIndex);
+    }
+
+    auto result = readDatabase(batch);
+    for (const auto& kv: result.getSpentKeyImagesByBlock()) {
+      for (const auto& keyImage: kv.second) {
+        spentKeyImagesFilter.add(keyImage);
+      }
+    }
+  }
 }
 
 std::vector<BinaryArray>
@@ -1540,13 +1663,28 @@ ExtractOutputKeysResult DatabaseBlockchainCache::extractKeyOutputs(
     uint64_t amount, uint32_t blockIndex, Common::ArrayView<uint32_t> globalIndexes,
     std::function<ExtractOutputKeysResult(const CachedTransactionInfo& info, PackedOutIndex index,
                                           uint32_t globalIndex)> callback) const {
+  std::map<std::pair<IBlockchainCache::Amount, IBlockchainCache::GlobalOutputIndex>, KeyOutputInfo> sortedResult;
+
   BlockchainReadBatch batch;
+  bool cacheMissed = false;
   for (auto it = globalIndexes.begin(); it != globalIndexes.end(); ++it) {
-    batch.requestKeyOutputInfo(amount, *it);
+    auto key = std::make_pair(amount, *it);
+    KeyOutputInfo outputInfo;
+    if (keyOutputsCache.get(key, outputInfo)) {
+      sortedResult.emplace(key, outputInfo);
+    } else {
+      batch.requestKeyOutputInfo(amount, *it);
+      cacheMissed = true;
+    }
   }
 
-  auto result = readDatabase(batch).getKeyOutputInfo();
-  std::map<std::pair<IBlockchainCache::Amount, IBlockchainCache::GlobalOutputIndex>, KeyOutputInfo> sortedResult(result.begin(), result.end());
+  if (cacheMissed) {
+    auto result = readDatabase(batch);
+    for (const auto& kv: result.getKeyOutputInfo()) {
+      keyOutputsCache.put(kv.first, kv.second);
+      sortedResult.emplace(kv.first, kv.second);
+    }
+  }
   for (const auto& kv: sortedResult) {
     ExtendedTransactionInfo tx;
     tx.unlockTime = kv.second.unlockTime;
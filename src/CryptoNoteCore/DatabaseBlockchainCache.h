@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "Common/LruCache.h"
 #include "Common/StringView.h"
 #include "Currency.h"
 #include "IBlockchainCache.h"
@@ -26,6 +27,7 @@
 #include <CryptoNoteCore/BlockchainWriteBatch.h>
 #include <CryptoNoteCore/DatabaseCacheData.h>
 #include <CryptoNoteCore/IBlockchainCacheFactory.h>
+#include <CryptoNoteCore/KeyImagesFilter.h>
 
 namespace CryptoNote {
 
@@ -170,6 +172,10 @@ private:
   Logging::LoggerRef logger;
   std::deque<CachedBlockInfo> unitsCache;
   const size_t unitsCacheSize = 1000;
+  // Key output infos by amount and global index, filled on push and by reads, so ring members used again don't go to disk
+  mutable Common::ShardedLruCache<std::pair<Amount, GlobalOutputIndex>, KeyOutputInfo> keyOutputsCache {200000, 16};
+  KeyImagesFilter spentKeyImagesFilter;
+  bool spentKeyImagesFilterLoaded = false;
 
   struct ExtendedPushedBlockInfo;
   ExtendedPushedBlockInfo getExtendedPushedBlockInfo(uint32_t blockIndex) const;
@@ -179,6 +185,7 @@ private:
   BlockchainReadResult readDatabase(BlockchainReadBatch& batch) const;
 
   void addSpentKeyImage(const Crypto::KeyImage& keyImage, uint32_t blockIndex);
+  void buildSpentKeyImagesFilter();
   void pushTransaction(const CachedTransaction& cachedTransaction,
                        uint32_t blockIndex,
                        uint16_t transactionBlockIndex,
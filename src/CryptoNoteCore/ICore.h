@@ -21,6 +21,7 @@
 
 #include "AddBlockErrors.h"
 #include "AddBlockErrorCondition.h"
+#include "BlockFilter.h"
 #include "BlockchainExplorerData.h"
 #include "BlockchainMessages.h"
 #include "CachedBlock.h"
@@ -30,6 +31,10 @@
 #include "ICoreDefinitions.h"
 #include "MessageQueue.h"
 
+namespace Common {
+class ThreadPool;
+}
+
 namespace CryptoNote {
 
 enum class CoreEvent { POOL_UPDATED, BLOCKHAIN_UPDATED };
@@ -64,6 +69,10 @@ public:
   virtual bool queryBlocksLite(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp,
                                uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset,
                                std::vector<BlockShortInfo>& entries) const = 0;
+  virtual bool queryBlockFilters(const std::vector<Crypto::Hash>& knownBlockHashes, uint64_t timestamp,
+                                 uint32_t& startIndex, uint32_t& currentIndex, uint32_t& fullOffset,
+                                 std::vector<BlockFilter>& entries) const = 0;
+  virtual bool getBlocksLite(const std::vector<Crypto::Hash>& blockHashes, std::vector<BlockShortInfo>& entries) const = 0;
 
   virtual bool hasTransaction(const Crypto::Hash& transactionHash) const = 0;
   virtual void getTransactions(const std::vector<Crypto::Hash>& transactionHashes,
@@ -73,6 +82,11 @@ public:
   virtual uint64_t getBlockDifficulty(uint32_t blockIndex) const = 0;
   virtual uint64_t getDifficultyForNextBlock() const = 0;
 
+  // Calculates the proof of work hashes of the blocks that will need them on the core's worker threads, ahead of addBlock.
+  // Can be called from any thread, as long as the blocks aren't used elsewhere meanwhile
+  virtual void precalculateBlockLongHashes(const std::vector<CachedBlock>& blocks) = 0;
+  // The core's worker threads, for other work on blocks done ahead of adding them
+  virtual Common::ThreadPool& getValidationThreadPool() = 0;
   virtual std::error_code addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlock) = 0;
   virtual std::error_code addBlock(RawBlock&& rawBlock) = 0;
 
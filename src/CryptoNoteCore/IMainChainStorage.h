@@ -32,6 +32,7 @@ public:
   virtual uint32_t getBlockCount() const = 0;
 
   virtual void clear() = 0;
+  virtual void flush() = 0;
 };
 
 }
@@ -25,6 +25,7 @@ struct TransactionValidatorState;
 class ITransactionPool {
 public:
   virtual bool pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState) = 0;
+  virtual bool pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState, uint64_t receiveTime) = 0;
   virtual const CachedTransaction& getTransaction(const Crypto::Hash& hash) const = 0;
   virtual bool removeTransaction(const Crypto::Hash& hash) = 0;
 
@@ -37,6 +38,12 @@ public:
 
   virtual uint64_t getTransactionReceiveTime(const Crypto::Hash& hash) const = 0;
   virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash& paymentId) const = 0;
+  // Pool transactions spending any of the key images of the state, found by lookup rather than by walking the pool
+  virtual std::vector<Crypto::Hash> getTransactionHashesByKeyImages(const TransactionValidatorState& state) const = 0;
+  virtual std::vector<Crypto::Hash> getTransactionHashesLargerThan(size_t size) const = 0;
+
+  // Changes every time a transaction is added or removed, so results derived from the pool can be reused until then
+  virtual uint64_t getVersion() const = 0;
 };
 
 }
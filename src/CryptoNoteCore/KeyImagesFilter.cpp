@@ -0,0 +1,74 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "KeyImagesFilter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace CryptoNote {
+
+namespace {
+
+// 8 MiB, about 0.2% false positives with five million key images
+const uint64_t FILTER_BITS = UINT64_C(1) << 26;
+const size_t FILTER_HASHES = 7;
+
+/* Key images are curve points that already look random, so the bit positions
+   are taken straight from their bytes with double hashing */
+void getHashes(const Crypto::KeyImage& keyImage, uint64_t& first, uint64_t& second) {
+  std::memcpy(&first, keyImage.data, sizeof(first));
+  std::memcpy(&second, keyImage.data + sizeof(first), sizeof(second));
+  second |= 1;
+}
+
+}
+
+KeyImagesFilter::KeyImagesFilter() : bits(FILTER_BITS / 64, 0) {
+}
+
+void KeyImagesFilter::add(const Crypto::KeyImage& keyImage) {
+  uint64_t first;
+  uint64_t second;
+  getHashes(keyImage, first, second);
+
+  for (size_t i = 0; i < FILTER_HASHES; ++i) {
+    uint64_t bit = (first + i * second) % FILTER_BITS;
+    bits[bit / 64] |= UINT64_C(1) << (bit % 64);
+  }
+}
+
+bool KeyImagesFilter::mayContain(const Crypto::KeyImage& keyImage) const {
+  uint64_t first;
+  uint64_t second;
+  getHashes(keyImage, first, second);
+
+  for (size_t i = 0; i < FILTER_HASHES; ++i) {
+    uint64_t bit = (first + i * second) % FILTER_BITS;
+    if ((bits[bit / 64] & (UINT64_C(1) << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void KeyImagesFilter::clear() {
+  std::fill(bits.begin(), bits.end(), 0);
+}
+
+std::string KeyImagesFilter::toBinary() const {
+  return std::string(reinterpret_cast<const char*>(bits.data()), bits.size() * sizeof(uint64_t));
+}
+
+bool KeyImagesFilter::fromBinary(const std::string& binary) {
+  if (binary.size() != bits.size() * sizeof(uint64_t)) {
+    return false;
+  }
+
+  std::memcpy(bits.data(), binary.data(), binary.size());
+  return true;
+}
+
+}
@@ -0,0 +1,34 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <CryptoTypes.h>
+
+namespace CryptoNote {
+
+/* Bloom filter over key images. mayContain never returns false for an added
+   key image, so a miss means the key image is definitely not in the set and
+   only hits need to be confirmed elsewhere. Key images can't be removed, a
+   filter that still holds removed ones only gives more false positives */
+class KeyImagesFilter {
+public:
+  KeyImagesFilter();
+
+  void add(const Crypto::KeyImage& keyImage);
+  bool mayContain(const Crypto::KeyImage& keyImage) const;
+  void clear();
+
+  std::string toBinary() const;
+  bool fromBinary(const std::string& binary);
+
+private:
+  std::vector<uint64_t> bits;
+};
+
+}
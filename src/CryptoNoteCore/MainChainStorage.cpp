@@ -17,53 +17,171 @@
 
 #include "MainChainStorage.h"
 
+#include <algorithm>
+
 #include <boost/filesystem.hpp>
 
+#include "Common/MemoryInputStream.h"
 #include "CryptoNoteTools.h"
+#include "Logging/LoggerRef.h"
+#include "SwappedVector.h"
 
 namespace CryptoNote {
 
-const size_t STORAGE_CACHE_SIZE = 100;
+namespace {
+
+// The data file grows in large steps, as every resize unmaps and maps it again
+const uint64_t BLOCKS_FILE_MIN_GROWTH = 64 * 1024 * 1024;
+
+const uint64_t IMPORT_PROGRESS_INTERVAL = 10000;
+
+void importSwappedStorage(const std::string& legacyBlocksFilename, const std::string& legacyIndexesFilename,
+                          IMainChainStorage& storage, Logging::LoggerRef& logger) {
+  SwappedVector<RawBlock> legacyStorage;
+  if (!legacyStorage.open(legacyBlocksFilename, legacyIndexesFilename, 1)) {
+    throw std::runtime_error("Failed to open main chain storage: " + legacyBlocksFilename);
+  }
+
+  uint64_t blockCount = legacyStorage.size();
+  for (uint64_t i = 0; i < blockCount; ++i) {
+    storage.pushBlock(legacyStorage[i]);
 
-MainChainStorage::MainChainStorage(const std::string& blocksFilename, const std::string& indexesFilename) {
-  if (!storage.open(blocksFilename, indexesFilename, STORAGE_CACHE_SIZE)) {
-    throw std::runtime_error("Failed to load main chain storage: " + blocksFilename);
+    if ((i + 1) % IMPORT_PROGRESS_INTERVAL == 0) {
+      logger(Logging::INFO) << "Imported " << i + 1 << " of " << blockCount << " blocks";
+    }
+  }
+}
+
+}
+
+MainChainStorage::MainChainStorage(const std::string& blocksFilename, const std::string& offsetsFilename) {
+  // Flushing every block costs a sync per push, the core flushes the files on save and periodically
+  blockEndOffsets.open(offsetsFilename, Common::FileMappedVectorOpenMode::OPEN_OR_CREATE);
+  blockEndOffsets.setAutoFlush(false);
+
+  // An empty file can't be mapped, so the data file always keeps some capacity
+  if (!boost::filesystem::exists(blocksFilename) || boost::filesystem::file_size(blocksFilename) == 0) {
+    blocks.create(blocksFilename, BLOCKS_FILE_MIN_GROWTH, true);
+  } else {
+    blocks.open(blocksFilename);
+  }
+
+  if (!blockEndOffsets.empty() && blockEndOffsets.back() > blocks.size()) {
+    throw std::runtime_error("Failed to load main chain storage, the index refers past the end of " + blocksFilename);
   }
 }
 
 MainChainStorage::~MainChainStorage() {
-  storage.close();
+  try {
+    flush();
+  } catch (std::exception&) {
+  }
+
+  std::error_code ignore;
+  blockEndOffsets.close(ignore);
+  blocks.close(ignore);
 }
 
 void MainChainStorage::pushBlock(const RawBlock& rawBlock) {
-  storage.push_back(rawBlock);
+  BinaryArray data = toBinaryArray(rawBlock);
+
+  boost::unique_lock<boost::shared_mutex> lock(storageMutex);
+  uint64_t offset = getBlockOffset(static_cast<uint32_t>(blockEndOffsets.size()));
+  reserveBlocksFile(offset + data.size());
+
+  std::copy(data.begin(), data.end(), blocks.data() + offset);
+  blockEndOffsets.push_back(offset + data.size());
 }
 
 void MainChainStorage::popBlock() {
-  storage.pop_back();
+  boost::unique_lock<boost::shared_mutex> lock(storageMutex);
+  if (blockEndOffsets.empty()) {
+    throw std::runtime_error("Failed to pop block, main chain storage is empty");
+  }
+
+  blockEndOffsets.pop_back();
 }
 
 RawBlock MainChainStorage::getBlockByIndex(uint32_t index) const {
-  if (index >= storage.size()) {
-    throw std::out_of_range("Block index " + std::to_string(index) + " is out of range. Blocks count: " + std::to_string(storage.size()));
+  boost::shared_lock<boost::shared_mutex> lock(storageMutex);
+  if (index >= blockEndOffsets.size()) {
+    throw std::out_of_range("Block index " + std::to_string(index) + " is out of range. Blocks count: " + std::to_string(blockEndOffsets.size()));
   }
 
-  return storage[index];
+  uint64_t offset = getBlockOffset(index);
+  Common::MemoryInputStream stream(blocks.data() + offset, static_cast<size_t>(blockEndOffsets[index] - offset));
+  BinaryInputStreamSerializer serializer(stream);
+
+  RawBlock rawBlock;
+  serialize(rawBlock, serializer);
+  return rawBlock;
 }
 
 uint32_t MainChainStorage::getBlockCount() const {
-  return static_cast<uint32_t>(storage.size());
+  boost::shared_lock<boost::shared_mutex> lock(storageMutex);
+  return static_cast<uint32_t>(blockEndOffsets.size());
 }
 
 void MainChainStorage::clear() {
-  storage.clear();
+  boost::unique_lock<boost::shared_mutex> lock(storageMutex);
+  blockEndOffsets.clear();
+}
+
+void MainChainStorage::flush() {
+  boost::shared_lock<boost::shared_mutex> lock(storageMutex);
+  // The data first, so the index on disk never refers to blocks that are not there yet
+  blocks.flush(blocks.data(), getBlockOffset(static_cast<uint32_t>(blockEndOffsets.size())));
+  blockEndOffsets.flush();
+}
+
+uint64_t MainChainStorage::getBlockOffset(uint32_t index) const {
+  return index == 0 ? 0 : blockEndOffsets[index - 1];
+}
+
+void MainChainStorage::reserveBlocksFile(uint64_t size) {
+  if (size <= blocks.size()) {
+    return;
+  }
+
+  uint64_t newSize = std::max(size, blocks.size() + std::max(blocks.size() / 2, BLOCKS_FILE_MIN_GROWTH));
+  std::string path = blocks.path();
+
+  blocks.close();
+  boost::filesystem::resize_file(path, newSize);
+  blocks.open(path);
 }
 
-std::unique_ptr<IMainChainStorage> createSwappedMainChainStorage(const std::string& dataDir, const Currency& currency) {
-  boost::filesystem::path blocksFilename = boost::filesystem::path(dataDir) / currency.blocksFileName();
-  boost::filesystem::path indexesFilename = boost::filesystem::path(dataDir) / currency.blockIndexesFileName();
+std::unique_ptr<IMainChainStorage> createMainChainStorage(const std::string& dataDir, const Currency& currency, Logging::ILogger& logger) {
+  Logging::LoggerRef log(logger, "MainChainStorage");
+
+  boost::filesystem::path blocksFilename = boost::filesystem::path(dataDir) / currency.blocksDataFileName();
+  boost::filesystem::path offsetsFilename = boost::filesystem::path(dataDir) / currency.blockOffsetsFileName();
+  boost::filesystem::path legacyBlocksFilename = boost::filesystem::path(dataDir) / currency.blocksFileName();
+  boost::filesystem::path legacyIndexesFilename = boost::filesystem::path(dataDir) / currency.blockIndexesFileName();
+
+  if (!boost::filesystem::exists(offsetsFilename) && boost::filesystem::exists(legacyBlocksFilename) &&
+      boost::filesystem::exists(legacyIndexesFilename)) {
+    log(Logging::INFO) << "Importing blocks from " << legacyBlocksFilename.string() << " into the memory mapped storage";
+
+    // Imported into temporary files first, so an interrupted import starts over on the next run
+    std::string temporaryBlocksFilename = blocksFilename.string() + ".tmp";
+    std::string temporaryOffsetsFilename = offsetsFilename.string() + ".tmp";
+    boost::filesystem::remove(temporaryBlocksFilename);
+    boost::filesystem::remove(temporaryOffsetsFilename);
+
+    {
+      MainChainStorage importedStorage(temporaryBlocksFilename, temporaryOffsetsFilename);
+      importSwappedStorage(legacyBlocksFilename.string(), legacyIndexesFilename.string(), importedStorage, log);
+    }
+
+    boost::filesystem::rename(temporaryBlocksFilename, blocksFilename);
+    boost::filesystem::rename(temporaryOffsetsFilename, offsetsFilename);
+
+    log(Logging::INFO) << "Blocks imported, " << legacyBlocksFilename.string() << " and "
+                       << legacyIndexesFilename.string() << " are no longer used and can be removed";
+  }
 
-  std::unique_ptr<IMainChainStorage> storage(new MainChainStorage(blocksFilename.string(), indexesFilename.string()));
+  std::unique_ptr<IMainChainStorage> storage(new MainChainStorage(blocksFilename.string(), offsetsFilename.string()));
   if (storage->getBlockCount() == 0) {
     RawBlock genesis;
     genesis.block = toBinaryArray(currency.genesisBlock());
@@ -17,15 +17,21 @@
 
 #pragma once
 
+#include <boost/thread/shared_mutex.hpp>
+
+#include "Common/FileMappedVector.h"
 #include "IMainChainStorage.h"
 #include "Currency.h"
-#include "SwappedVector.h"
+#include "Logging/ILogger.h"
+#include "System/MemoryMappedFile.h"
 
 namespace CryptoNote {
 
+/* Main chain blocks appended to a memory mapped data file, with the end offset of every block kept
+   in a file mapped index. Blocks are decoded straight from the mapping, without file reads or a cache */
 class MainChainStorage: public IMainChainStorage {
 public:
-  MainChainStorage(const std::string& blocksFilame, const std::string& indexesFilename);
+  MainChainStorage(const std::string& blocksFilename, const std::string& offsetsFilename);
   virtual ~MainChainStorage();
 
   virtual void pushBlock(const RawBlock& rawBlock) override;
@@ -35,11 +41,19 @@ public:
   virtual uint32_t getBlockCount() const override;
 
   virtual void clear() override;
+  virtual void flush() override;
 
 private:
-  mutable SwappedVector<RawBlock> storage;
+  // Growing the data file remaps it, so reads share the lock and writes take it exclusively
+  mutable boost::shared_mutex storageMutex;
+  System::MemoryMappedFile blocks;
+  Common::FileMappedVector<uint64_t> blockEndOffsets;
+
+  uint64_t getBlockOffset(uint32_t index) const;
+  void reserveBlocksFile(uint64_t size);
 };
 
-std::unique_ptr<IMainChainStorage> createSwappedMainChainStorage(const std::string& dataDir, const Currency& currency);
+/* Blocks kept by older versions in the swapped vector files are imported on the first start */
+std::unique_ptr<IMainChainStorage> createMainChainStorage(const std::string& dataDir, const Currency& currency, Logging::ILogger& logger);
 
 }
@@ -0,0 +1,73 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "RingSignatureVerifier.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace CryptoNote {
+
+namespace {
+
+/* Takes checks one at a time from the shared counter, so a few big rings
+   don't leave the other threads idle. Stops early once any check has failed */
+void verifyNextChecks(const std::vector<RingSignatureCheck>& checks, std::atomic<size_t>& nextCheck,
+                      std::atomic<size_t>& firstFailedCheck) {
+  for (;;) {
+    size_t index = nextCheck.fetch_add(1);
+    if (index >= checks.size() || index > firstFailedCheck.load()) {
+      return;
+    }
+
+    if (!verifyRingSignature(checks[index])) {
+      size_t failed = firstFailedCheck.load();
+      while (index < failed && !firstFailedCheck.compare_exchange_weak(failed, index)) {
+      }
+
+      return;
+    }
+  }
+}
+
+}
+
+bool verifyRingSignature(const RingSignatureCheck& check) {
+  std::vector<const Crypto::PublicKey*> outputKeyPointers;
+  outputKeyPointers.reserve(check.outputKeys.size());
+  for (const auto& key : check.outputKeys) {
+    outputKeyPointers.push_back(&key);
+  }
+
+  return Crypto::check_ring_signature(check.prefixHash, check.keyImage, outputKeyPointers.data(),
+                                      outputKeyPointers.size(), check.signatures, check.checkKeyImage);
+}
+
+size_t verifyRingSignatures(const std::vector<RingSignatureCheck>& checks, Common::ThreadPool* threadPool) {
+  std::atomic<size_t> nextCheck(0);
+  std::atomic<size_t> firstFailedCheck(checks.size());
+
+  if (threadPool == nullptr || checks.size() < 2) {
+    verifyNextChecks(checks, nextCheck, firstFailedCheck);
+    return firstFailedCheck.load();
+  }
+
+  size_t jobCount = std::min(threadPool->getThreadCount(), checks.size() - 1);
+
+  std::vector<std::future<void>> jobs;
+  jobs.reserve(jobCount);
+  for (size_t i = 0; i < jobCount; ++i) {
+    jobs.push_back(threadPool->addJob([&] { verifyNextChecks(checks, nextCheck, firstFailedCheck); }));
+  }
+
+  verifyNextChecks(checks, nextCheck, firstFailedCheck);
+
+  for (auto& job : jobs) {
+    job.get();
+  }
+
+  return firstFailedCheck.load();
+}
+
+}
@@ -0,0 +1,33 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <vector>
+
+#include "CachedTransaction.h"
+#include "Common/ThreadPool.h"
+#include <crypto/crypto.h>
+
+namespace CryptoNote {
+
+/* Everything needed to check the ring signature of a single key input, once
+   the ring members have been looked up in the blockchain */
+struct RingSignatureCheck {
+  const CachedTransaction* transaction;
+  Crypto::Hash prefixHash;
+  Crypto::KeyImage keyImage;
+  std::vector<Crypto::PublicKey> outputKeys;
+  const Crypto::Signature* signatures;
+  bool checkKeyImage;
+};
+
+bool verifyRingSignature(const RingSignatureCheck& check);
+
+/* Verifies the checks on the pool's threads, with the calling thread helping
+   out. Returns the index of the first failed check, or checks.size() if all of
+   them passed. Without a pool the checks run on the calling thread */
+size_t verifyRingSignatures(const std::vector<RingSignatureCheck>& checks, Common::ThreadPool* threadPool);
+
+}
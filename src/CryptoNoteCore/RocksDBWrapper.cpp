@@ -17,12 +17,17 @@
 
 #include "RocksDBWrapper.h"
 
+#include <algorithm>
+
 #include "rocksdb/cache.h"
+#include "rocksdb/convenience.h"
+#include "rocksdb/filter_policy.h"
 #include "rocksdb/table.h"
 #include "rocksdb/db.h"
 #include "rocksdb/utilities/backupable_db.h"
 
 #include "DataBaseErrors.h"
+#include "DBUtils.h"
 
 using namespace CryptoNote;
 using namespace Logging;
@@ -30,6 +35,48 @@ using namespace Logging;
 namespace {
   const std::string DB_NAME = "DB";
   const std::string TESTNET_DB_NAME = "testnet_DB";
+
+  // Keys are split into column families by their prefix, so each kind of data gets tuning that
+  // suits how it is read and a share of the read cache that other kinds can't evict
+  struct ColumnFamilyLayout {
+    std::string name;
+    std::vector<std::string> keyPrefixes;
+    uint64_t readCacheShare; // percent of DataBaseConfig::getReadCacheSize
+    bool compressed;
+    bool bloomFilter;
+    size_t blockSize;
+  };
+
+  const std::vector<ColumnFamilyLayout> COLUMN_FAMILIES = {
+    // Scheme version and anything else without a known prefix
+    { rocksdb::kDefaultColumnFamilyName, {}, 5, false, false, 4 * 1024 },
+
+    // Bulk data, read mostly in order when serving and importing blocks
+    { "raw_blocks", { DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX }, 10, true, false, 64 * 1024 },
+
+    { "block_index", { DB::BLOCK_INDEX_TO_TX_HASHES_PREFIX, DB::BLOCK_INDEX_TO_TRANSACTION_INFO_PREFIX, DB::BLOCK_HASH_TO_BLOCK_INDEX_PREFIX,
+                       DB::BLOCK_INDEX_TO_BLOCK_INFO_PREFIX, DB::BLOCK_INDEX_TO_BLOCK_HASH_PREFIX, DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX,
+                       DB::TIMESTAMP_TO_BLOCKHASHES_PREFIX }, 20, false, true, 4 * 1024 },
+
+    { "transactions", { DB::TRANSACTION_HASH_TO_TRANSACTION_INFO_PREFIX, DB::PAYMENT_ID_TO_TX_HASH_PREFIX }, 15, true, true, 16 * 1024 },
+
+    // Random point lookups on every validated input, the keys are hashes and don't compress
+    { "key_images", { DB::BLOCK_INDEX_TO_KEY_IMAGE_PREFIX, DB::KEY_IMAGE_TO_BLOCK_INDEX_PREFIX }, 25, false, true, 4 * 1024 },
+
+    { "key_outputs", { DB::KEY_OUTPUT_AMOUNT_PREFIX, DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX, DB::KEY_OUTPUT_KEY_PREFIX }, 25, false, true, 4 * 1024 }
+  };
+
+  // Builds are free to leave out compression libraries, so use the best one that was linked in
+  rocksdb::CompressionType getCompressionType() {
+    std::vector<rocksdb::CompressionType> supported = rocksdb::GetSupportedCompressions();
+    for (rocksdb::CompressionType type : { rocksdb::kLZ4Compression, rocksdb::kSnappyCompression, rocksdb::kZSTD, rocksdb::kZlibCompression }) {
+      if (std::find(supported.begin(), supported.end(), type) != supported.end()) {
+        return type;
+      }
+    }
+
+    return rocksdb::kNoCompression;
+  }
 }
 
 RocksDBWrapper::RocksDBWrapper(Logging::ILogger& logger) : logger(logger, "RocksDBWrapper"), state(NOT_INITIALIZED){
@@ -37,7 +84,9 @@ RocksDBWrapper::RocksDBWrapper(Logging::ILogger& logger) : logger(logger, "Rocks
 }
 
 RocksDBWrapper::~RocksDBWrapper() {
-
+  if (state.load() == INITIALIZED) {
+    closeColumnFamilies();
+  }
 }
 
 void RocksDBWrapper::init(const DataBaseConfig& config) {
@@ -51,14 +100,16 @@ void RocksDBWrapper::init(const DataBaseConfig& config) {
 
   rocksdb::DB* dbPtr;
 
-  rocksdb::Options dbOptions = getDBOptions(config);
-  rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, &dbPtr);
+  rocksdb::DBOptions dbOptions = getDBOptions(config);
+  std::vector<rocksdb::ColumnFamilyDescriptor> columnFamilyDescriptors = getColumnFamilies(config);
+  std::vector<rocksdb::ColumnFamilyHandle*> columnFamilyHandles;
+  rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, columnFamilyDescriptors, &columnFamilyHandles, &dbPtr);
   if (status.ok()) {
     logger(INFO) << "DB opened in " << dataDir;
   } else if (!status.ok() && status.IsInvalidArgument()) {
     logger(INFO) << "DB not found in " << dataDir << ". Creating new DB...";
     dbOptions.create_if_missing = true;
-    rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, &dbPtr);
+    rocksdb::Status status = rocksdb::DB::Open(dbOptions, dataDir, columnFamilyDescriptors, &columnFamilyHandles, &dbPtr);
     if (!status.ok()) {
       logger(ERROR) << "DB Error. DB can't be created in " << dataDir << ". Error: " << status.ToString();
       throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR));
@@ -72,6 +123,14 @@ void RocksDBWrapper::init(const DataBaseConfig& config) {
   }
 
   db.reset(dbPtr);
+
+  columnFamilies = columnFamilyHandles;
+  for (size_t i = 0; i < COLUMN_FAMILIES.size(); ++i) {
+    for (const std::string& keyPrefix : COLUMN_FAMILIES[i].keyPrefixes) {
+      columnFamiliesByKeyPrefix[keyPrefix] = columnFamilies[i];
+    }
+  }
+
   state.store(INITIALIZED);
 }
 
@@ -81,8 +140,12 @@ void RocksDBWrapper::shutdown() {
   }
 
   logger(INFO) << "Closing DB.";
-  db->Flush(rocksdb::FlushOptions());
+  for (rocksdb::ColumnFamilyHandle* columnFamily : columnFamilies) {
+    db->Flush(rocksdb::FlushOptions(), columnFamily);
+  }
+
   db->SyncWAL();
+  closeColumnFamilies();
   db.reset();
   state.store(NOT_INITIALIZED);
 }
@@ -96,8 +159,8 @@ void RocksDBWrapper::destroy(const DataBaseConfig& config) {
 
   logger(WARNING) << "Destroying DB in " << dataDir;
 
-  rocksdb::Options dbOptions = getDBOptions(config);
-  rocksdb::Status status = rocksdb::DestroyDB(dataDir, dbOptions);
+  rocksdb::Options dbOptions(getDBOptions(config), rocksdb::ColumnFamilyOptions());
+  rocksdb::Status status = rocksdb::DestroyDB(dataDir, dbOptions, getColumnFamilies(config));
 
   if (status.ok()) {
     logger(WARNING) << "DB destroyed in " << dataDir;
@@ -130,12 +193,12 @@ std::error_code RocksDBWrapper::write(IWriteBatch& batch, bool sync) {
   rocksdb::WriteBatch rocksdbBatch;
   std::vector<std::pair<std::string, std::string>> rawData(batch.extractRawDataToInsert());
   for (const std::pair<std::string, std::string>& kvPair : rawData) {
-    rocksdbBatch.Put(rocksdb::Slice(kvPair.first), rocksdb::Slice(kvPair.second));
+    rocksdbBatch.Put(getColumnFamily(kvPair.first), rocksdb::Slice(kvPair.first), rocksdb::Slice(kvPair.second));
   }
 
   std::vector<std::string> rawKeys(batch.extractRawKeysToRemove());
   for (const std::string& key : rawKeys) {
-    rocksdbBatch.Delete(rocksdb::Slice(key));
+    rocksdbBatch.Delete(getColumnFamily(key), rocksdb::Slice(key));
   }
 
   rocksdb::Status status = db->Write(writeOptions, &rocksdbBatch);
@@ -157,14 +220,17 @@ std::error_code RocksDBWrapper::read(IReadBatch& batch) {
 
   std::vector<std::string> rawKeys(batch.getRawKeys());
   std::vector<rocksdb::Slice> keySlices;
+  std::vector<rocksdb::ColumnFamilyHandle*> keyColumnFamilies;
   keySlices.reserve(rawKeys.size());
+  keyColumnFamilies.reserve(rawKeys.size());
   for (const std::string& key : rawKeys) {
     keySlices.emplace_back(rocksdb::Slice(key));
+    keyColumnFamilies.push_back(getColumnFamily(key));
   }
 
   std::vector<std::string> values;
   values.reserve(rawKeys.size());
-  std::vector<rocksdb::Status> statuses = db->MultiGet(readOptions, keySlices, &values);
+  std::vector<rocksdb::Status> statuses = db->MultiGet(readOptions, keyColumnFamilies, keySlices, &values);
 
   std::error_code error;
   std::vector<bool> resultStates;
@@ -179,47 +245,86 @@ std::error_code RocksDBWrapper::read(IReadBatch& batch) {
   return std::error_code();
 }
 
-rocksdb::Options RocksDBWrapper::getDBOptions(const DataBaseConfig& config) {
+rocksdb::DBOptions RocksDBWrapper::getDBOptions(const DataBaseConfig& config) {
   rocksdb::DBOptions dbOptions;
   dbOptions.IncreaseParallelism(config.getBackgroundThreadsCount());
   dbOptions.info_log_level = rocksdb::InfoLogLevel::WARN_LEVEL;
   dbOptions.max_open_files = config.getMaxOpenFiles();
+  dbOptions.create_missing_column_families = true;
+
+  return dbOptions;
+}
+
+std::vector<rocksdb::ColumnFamilyDescriptor> RocksDBWrapper::getColumnFamilies(const DataBaseConfig& config) {
+  const rocksdb::CompressionType compressionType = getCompressionType();
+
+  std::vector<rocksdb::ColumnFamilyDescriptor> columnFamilyDescriptors;
+  columnFamilyDescriptors.reserve(COLUMN_FAMILIES.size());
+
+  for (const ColumnFamilyLayout& layout : COLUMN_FAMILIES) {
+    rocksdb::ColumnFamilyOptions fOptions;
+    fOptions.write_buffer_size = static_cast<size_t>(config.getWriteBufferSize());
+    // merge two memtables when flushing to L0
+    fOptions.min_write_buffer_number_to_merge = 2;
+    // this means we'll use 50% extra memory in the worst case, but will reduce
+    // write stalls.
+    fOptions.max_write_buffer_number = 6;
+    // start flushing L0->L1 as soon as possible. each file on level0 is
+    // (memtable_memory_budget / 2). This will flush level 0 when it's bigger than
+    // memtable_memory_budget.
+    fOptions.level0_file_num_compaction_trigger = 20;
+
+    fOptions.level0_slowdown_writes_trigger = 30;
+    fOptions.level0_stop_writes_trigger = 40;
+
+    // doesn't really matter much, but we don't want to create too many files
+    fOptions.target_file_size_base = config.getWriteBufferSize() / 10;
+    // make Level1 size equal to Level0 size, so that L0->L1 compactions are fast
+    fOptions.max_bytes_for_level_base = config.getWriteBufferSize();
+    fOptions.num_levels = 10;
+    fOptions.target_file_size_multiplier = 2;
+    // level style compaction
+    fOptions.compaction_style = rocksdb::kCompactionStyleLevel;
+
+    // the two top levels are rewritten often, so only compress the rest
+    fOptions.compression_per_level.resize(fOptions.num_levels);
+    for (int i = 0; i < fOptions.num_levels; ++i) {
+      fOptions.compression_per_level[i] = (layout.compressed && i >= 2) ? compressionType : rocksdb::kNoCompression;
+    }
+
+    rocksdb::BlockBasedTableOptions tableOptions;
+    tableOptions.block_cache = rocksdb::NewLRUCache(config.getReadCacheSize() * layout.readCacheShare / 100);
+    tableOptions.block_size = layout.blockSize;
+    if (layout.bloomFilter) {
+      tableOptions.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
+    }
+
+    std::shared_ptr<rocksdb::TableFactory> tfp(NewBlockBasedTableFactory(tableOptions));
+    fOptions.table_factory = tfp;
+
+    columnFamilyDescriptors.emplace_back(layout.name, fOptions);
+  }
+
+  return columnFamilyDescriptors;
+}
+
+rocksdb::ColumnFamilyHandle* RocksDBWrapper::getColumnFamily(const std::string& rawKey) const {
+  auto it = columnFamiliesByKeyPrefix.find(DB::getKeyPrefix(rawKey));
+  if (it == columnFamiliesByKeyPrefix.end()) {
+    return db->DefaultColumnFamily();
+  }
+
+  return it->second;
+}
+
+void RocksDBWrapper::closeColumnFamilies() {
+  columnFamiliesByKeyPrefix.clear();
+
+  for (rocksdb::ColumnFamilyHandle* columnFamily : columnFamilies) {
+    db->DestroyColumnFamilyHandle(columnFamily);
+  }
 
-  rocksdb::ColumnFamilyOptions fOptions;
-  fOptions.write_buffer_size = static_cast<size_t>(config.getWriteBufferSize());
-  // merge two memtables when flushing to L0
-  fOptions.min_write_buffer_number_to_merge = 2;
-  // this means we'll use 50% extra memory in the worst case, but will reduce
-  // write stalls.
-  fOptions.max_write_buffer_number = 6;
-  // start flushing L0->L1 as soon as possible. each file on level0 is
-  // (memtable_memory_budget / 2). This will flush level 0 when it's bigger than
-  // memtable_memory_budget.
-  fOptions.level0_file_num_compaction_trigger = 20;
-
-  fOptions.level0_slowdown_writes_trigger = 30;
-  fOptions.level0_stop_writes_trigger = 40;
-
-  // doesn't really matter much, but we don't want to create too many files
-  fOptions.target_file_size_base = config.getWriteBufferSize() / 10;
-  // make Level1 size equal to Level0 size, so that L0->L1 compactions are fast
-  fOptions.max_bytes_for_level_base = config.getWriteBufferSize();
-  fOptions.num_levels = 10;
-  fOptions.target_file_size_multiplier = 2;
-  // level style compaction
-  fOptions.compaction_style = rocksdb::kCompactionStyleLevel;
-
-  fOptions.compression_per_level.resize(fOptions.num_levels);
-  for (int i = 0; i < fOptions.num_levels; ++i) {
-    fOptions.compression_per_level[i] = rocksdb::kNoCompression;
-  }
-
-  rocksdb::BlockBasedTableOptions tableOptions;
-  tableOptions.block_cache = rocksdb::NewLRUCache(config.getReadCacheSize());
-  std::shared_ptr<rocksdb::TableFactory> tfp(NewBlockBasedTableFactory(tableOptions));
-  fOptions.table_factory = tfp;
-
-  return rocksdb::Options(dbOptions, fOptions);
+  columnFamilies.clear();
 }
 
 std::string RocksDBWrapper::getDataDir(const DataBaseConfig& config) {
@@ -18,8 +18,10 @@
 #pragma once
 
 #include <atomic>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "rocksdb/db.h"
 
@@ -52,7 +54,10 @@ public:
 private:
   std::error_code write(IWriteBatch& batch, bool sync);
 
-  rocksdb::Options getDBOptions(const DataBaseConfig& config);
+  rocksdb::DBOptions getDBOptions(const DataBaseConfig& config);
+  std::vector<rocksdb::ColumnFamilyDescriptor> getColumnFamilies(const DataBaseConfig& config);
+  rocksdb::ColumnFamilyHandle* getColumnFamily(const std::string& rawKey) const;
+  void closeColumnFamilies();
   std::string getDataDir(const DataBaseConfig& config);
 
   enum State {
@@ -62,6 +67,8 @@ private:
 
   Logging::LoggerRef logger;
   std::unique_ptr<rocksdb::DB> db;
+  std::vector<rocksdb::ColumnFamilyHandle*> columnFamilies;
+  std::map<std::string, rocksdb::ColumnFamilyHandle*> columnFamiliesByKeyPrefix;
   std::atomic<State> state;
 };
 }
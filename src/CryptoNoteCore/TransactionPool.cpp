@@ -17,6 +17,8 @@
 
 #include "TransactionPool.h"
 
+#include <unordered_set>
+
 #include "Common/int-util.h"
 #include "CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/TransactionExtra.h"
@@ -49,6 +51,10 @@ const Crypto::Hash& TransactionPool::PendingTransactionInfo::getTransactionHash(
   return cachedTransaction.getTransactionHash();
 }
 
+size_t TransactionPool::PendingTransactionInfo::getTransactionSize() const {
+  return cachedTransaction.getTransactionBinaryArray().size();
+}
+
 size_t TransactionPool::PaymentIdHasher::operator() (const boost::optional<Crypto::Hash>& paymentId) const {
   if (!paymentId) {
     return std::numeric_limits<size_t>::max();
@@ -58,14 +64,20 @@ size_t TransactionPool::PaymentIdHasher::operator() (const boost::optional<Crypt
 }
 
 TransactionPool::TransactionPool(Logging::ILogger& logger) :
+  version(0),
   transactionHashIndex(transactions.get<TransactionHashTag>()),
   transactionCostIndex(transactions.get<TransactionCostTag>()),
   paymentIdIndex(transactions.get<PaymentIdTag>()),
+  transactionSizeIndex(transactions.get<TransactionSizeTag>()),
   logger(logger, "TransactionPool") {
 }
 
 bool TransactionPool::pushTransaction(CachedTransaction&& transaction, TransactionValidatorState&& transactionState) {
-  auto pendingTx = PendingTransactionInfo{static_cast<uint64_t>(time(nullptr)), std::move(transaction)};
+  return pushTransaction(std::move(transaction), std::move(transactionState), static_cast<uint64_t>(time(nullptr)));
+}
+
+bool TransactionPool::pushTransaction(CachedTransaction&& transaction, TransactionValidatorState&& transactionState, uint64_t receiveTime) {
+  auto pendingTx = PendingTransactionInfo{receiveTime, std::move(transaction)};
 
   Crypto::Hash paymentId;
   if(getPaymentIdFromTxExtra(pendingTx.cachedTransaction.getTransaction().extra, paymentId)) {
@@ -83,6 +95,11 @@ bool TransactionPool::pushTransaction(CachedTransaction&& transaction, Transacti
   }
 
   mergeStates(poolState, transactionState);
+  for (const auto& keyImage : transactionState.spentKeyImages) {
+    keyImageIndex.emplace(keyImage, pendingTx.getTransactionHash());
+  }
+
+  ++version;
 
   logger(Logging::DEBUGGING) << "pushed transaction " << pendingTx.getTransactionHash() << " to pool";
   return transactionHashIndex.emplace(std::move(pendingTx)).second;
@@ -103,7 +120,14 @@ bool TransactionPool::removeTransaction(const Crypto::Hash& hash) {
   }
 
   excludeFromState(poolState, it->cachedTransaction);
+  for (const auto& input : it->cachedTransaction.getTransaction().inputs) {
+    if (input.type() == typeid(KeyInput)) {
+      keyImageIndex.erase(boost::get<KeyInput>(input).keyImage);
+    }
+  }
+
   transactionHashIndex.erase(it);
+  ++version;
 
   logger(Logging::DEBUGGING) << "transaction " << hash << " removed from pool";
   return true;
@@ -161,4 +185,29 @@ std::vector<Crypto::Hash> TransactionPool::getTransactionHashesByPaymentId(const
   return transactionHashes;
 }
 
+std::vector<Crypto::Hash> TransactionPool::getTransactionHashesByKeyImages(const TransactionValidatorState& state) const {
+  std::unordered_set<Crypto::Hash> transactionHashes;
+  for (const auto& keyImage : state.spentKeyImages) {
+    auto it = keyImageIndex.find(keyImage);
+    if (it != keyImageIndex.end()) {
+      transactionHashes.insert(it->second);
+    }
+  }
+
+  return std::vector<Crypto::Hash>(transactionHashes.begin(), transactionHashes.end());
+}
+
+std::vector<Crypto::Hash> TransactionPool::getTransactionHashesLargerThan(size_t size) const {
+  std::vector<Crypto::Hash> transactionHashes;
+  for (auto it = transactionSizeIndex.upper_bound(size); it != transactionSizeIndex.end(); ++it) {
+    transactionHashes.push_back(it->getTransactionHash());
+  }
+
+  return transactionHashes;
+}
+
+uint64_t TransactionPool::getVersion() const {
+  return version;
+}
+
 }
@@ -39,6 +39,7 @@ public:
   TransactionPool(Logging::ILogger& logger);
 
   virtual bool pushTransaction(CachedTransaction&& transaction, TransactionValidatorState&& transactionState) override;
+  virtual bool pushTransaction(CachedTransaction&& transaction, TransactionValidatorState&& transactionState, uint64_t receiveTime) override;
   virtual const CachedTransaction& getTransaction(const Crypto::Hash& hash) const override;
   virtual bool removeTransaction(const Crypto::Hash& hash) override;
 
@@ -51,8 +52,14 @@ public:
 
   virtual uint64_t getTransactionReceiveTime(const Crypto::Hash& hash) const override;
   virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash& paymentId) const override;
+  virtual std::vector<Crypto::Hash> getTransactionHashesByKeyImages(const TransactionValidatorState& state) const override;
+  virtual std::vector<Crypto::Hash> getTransactionHashesLargerThan(size_t size) const override;
+  virtual uint64_t getVersion() const override;
 private:
   TransactionValidatorState poolState;
+  // the pool transaction spending each key image of poolState
+  std::unordered_map<Crypto::KeyImage, Crypto::Hash> keyImageIndex;
+  uint64_t version;
 
   struct PendingTransactionInfo {
     uint64_t receiveTime;
@@ -60,6 +67,7 @@ private:
     boost::optional<Crypto::Hash> paymentId;
 
     const Crypto::Hash& getTransactionHash() const;
+    size_t getTransactionSize() const;
   };
 
   struct TransactionPriorityComparator {
@@ -70,6 +78,7 @@ private:
   struct TransactionHashTag {};
   struct TransactionCostTag {};
   struct PaymentIdTag {};
+  struct TransactionSizeTag {};
 
   typedef boost::multi_index::ordered_non_unique<
     boost::multi_index::tag<TransactionCostTag>,
@@ -96,12 +105,22 @@ private:
     PaymentIdHasher
   > PaymentIdIndex;
 
+  typedef boost::multi_index::ordered_non_unique<
+    boost::multi_index::tag<TransactionSizeTag>,
+    boost::multi_index::const_mem_fun<
+      PendingTransactionInfo,
+      size_t,
+      &PendingTransactionInfo::getTransactionSize
+    >
+  > TransactionSizeIndex;
+
   typedef boost::multi_index_container<
     PendingTransactionInfo,
     boost::multi_index::indexed_by<
       TransactionHashIndex,
       TransactionCostIndex,
-      PaymentIdIndex
+      PaymentIdIndex,
+      TransactionSizeIndex
     >
   > TransactionsContainer;
 
@@ -109,6 +128,7 @@ private:
   TransactionsContainer::index<TransactionHashTag>::type& transactionHashIndex;
   TransactionsContainer::index<TransactionCostTag>::type& transactionCostIndex;
   TransactionsContainer::index<PaymentIdTag>::type& paymentIdIndex;
+  TransactionsContainer::index<TransactionSizeTag>::type& transactionSizeIndex;
   
   Logging::LoggerRef logger;
 };
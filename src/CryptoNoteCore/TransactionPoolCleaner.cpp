@@ -35,6 +35,10 @@ bool TransactionPoolCleanWrapper::pushTransaction(CachedTransaction&& tx, Transa
   return !isTransactionRecentlyDeleted(tx.getTransactionHash()) && transactionPool->pushTransaction(std::move(tx), std::move(transactionState));
 }
 
+bool TransactionPoolCleanWrapper::pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState, uint64_t receiveTime) {
+  return !isTransactionRecentlyDeleted(tx.getTransactionHash()) && transactionPool->pushTransaction(std::move(tx), std::move(transactionState), receiveTime);
+}
+
 const CachedTransaction& TransactionPoolCleanWrapper::getTransaction(const Crypto::Hash& hash) const {
   return transactionPool->getTransaction(hash);
 }
@@ -71,6 +75,18 @@ std::vector<Crypto::Hash> TransactionPoolCleanWrapper::getTransactionHashesByPay
   return transactionPool->getTransactionHashesByPaymentId(paymentId);
 }
 
+std::vector<Crypto::Hash> TransactionPoolCleanWrapper::getTransactionHashesByKeyImages(const TransactionValidatorState& state) const {
+  return transactionPool->getTransactionHashesByKeyImages(state);
+}
+
+std::vector<Crypto::Hash> TransactionPoolCleanWrapper::getTransactionHashesLargerThan(size_t size) const {
+  return transactionPool->getTransactionHashesLargerThan(size);
+}
+
+uint64_t TransactionPoolCleanWrapper::getVersion() const {
+  return transactionPool->getVersion();
+}
+
 std::vector<Crypto::Hash> TransactionPoolCleanWrapper::clean(const uint32_t height) {
   try {
     uint64_t currentTime = timeProvider->now();
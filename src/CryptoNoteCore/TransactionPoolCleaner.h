@@ -38,6 +38,7 @@ public:
   virtual ~TransactionPoolCleanWrapper();
 
   virtual bool pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState) override;
+  virtual bool pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState, uint64_t receiveTime) override;
   virtual const CachedTransaction& getTransaction(const Crypto::Hash& hash) const override;
   virtual bool removeTransaction(const Crypto::Hash& hash) override;
 
@@ -50,6 +51,9 @@ public:
 
   virtual uint64_t getTransactionReceiveTime(const Crypto::Hash& hash) const override;
   virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash& paymentId) const override;
+  virtual std::vector<Crypto::Hash> getTransactionHashesByKeyImages(const TransactionValidatorState& state) const override;
+  virtual std::vector<Crypto::Hash> getTransactionHashesLargerThan(size_t size) const override;
+  virtual uint64_t getVersion() const override;
 
   virtual std::vector<Crypto::Hash> clean(const uint32_t height) override;
 
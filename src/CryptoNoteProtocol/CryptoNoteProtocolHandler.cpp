@@ -10,6 +10,7 @@
 #include <boost/scope_exit.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <System/Dispatcher.h>
+#include <System/RemoteContext.h>
 
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
@@ -18,6 +19,7 @@
 #include "P2p/LevinProtocol.h"
 
 #include <Common/FormatTools.h>
+#include <Common/ThreadPool.h>
 
 #include <config/Ascii.h>
 #include <config/CryptoNoteConfig.h>
@@ -62,6 +64,43 @@ std::vector<RawBlock> convertRawBlocksLegacyToRawBlocks(const std::vector<RawBlo
   return rawBlocks;
 }
 
+// Deserializes the blocks and calculates their hashes on the pool's threads. Returns the number of
+// blocks that were decoded before the first one that couldn't be parsed
+size_t decodeBlocks(ThreadPool& threadPool, const std::vector<RawBlock>& rawBlocks, std::vector<BlockTemplate>& blockTemplates,
+                    std::vector<CachedBlock>& cachedBlocks) {
+  assert(blockTemplates.size() == rawBlocks.size());
+
+  std::vector<std::future<bool>> parsed;
+  parsed.reserve(rawBlocks.size());
+  for (size_t index = 0; index < rawBlocks.size(); ++index) {
+    parsed.push_back(threadPool.addJob([&, index] { return fromBinaryArray(blockTemplates[index], rawBlocks[index].block); }));
+  }
+
+  // Every job is waited for, the ones after a failed block still use the templates
+  bool failed = false;
+  for (size_t index = 0; index < parsed.size(); ++index) {
+    if (!parsed[index].get()) {
+      failed = true;
+    }
+
+    if (!failed) {
+      cachedBlocks.emplace_back(blockTemplates[index]);
+    }
+  }
+
+  std::vector<std::future<void>> hashed;
+  hashed.reserve(cachedBlocks.size());
+  for (auto& cachedBlock : cachedBlocks) {
+    hashed.push_back(threadPool.addJob([&cachedBlock] { cachedBlock.getBlockHash(); }));
+  }
+
+  for (auto& hash : hashed) {
+    hash.get();
+  }
+
+  return cachedBlocks.size();
+}
+
 }
 
 // unpack to strings to maintain protocol compatibility with older versions
@@ -438,6 +477,12 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
     return 1;
   }
 
+  if (context.m_state != CryptoNoteConnectionContext::state_synchronizing && context.m_requested_objects.empty()) {
+    // A batch requested ahead of time arrived after synchronization with this peer was stopped
+    logger(Logging::DEBUGGING) << context << "Ignoring NOTIFY_RESPONSE_GET_OBJECTS, connection isn't synchronizing";
+    return 1;
+  }
+
   updateObservedHeight(arg.current_blockchain_height, context);
   context.m_remote_blockchain_height = arg.current_blockchain_height;
   std::vector<BlockTemplate> blockTemplates;
@@ -447,17 +492,25 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
 
   std::vector<RawBlock> rawBlocks = convertRawBlocksLegacyToRawBlocks(arg.blocks);
 
+  // Other connections keep being served while the batch is decoded and its proof of work hashed
+  System::RemoteContext<size_t> decodeContext(m_dispatcher, [&] {
+    size_t decodedBlocks = decodeBlocks(m_core.getValidationThreadPool(), rawBlocks, blockTemplates, cachedBlocks);
+    m_core.precalculateBlockLongHashes(cachedBlocks);
+    return decodedBlocks;
+  });
+
+  size_t decodedBlocks = decodeContext.get();
+
   for (size_t index = 0; index < rawBlocks.size(); ++index) {
-    if (!fromBinaryArray(blockTemplates[index], rawBlocks[index].block)) {
+    if (index == decodedBlocks) {
       logger(Logging::ERROR) << context << "sent wrong block: failed to parse and validate block: \r\n"
         << toHex(rawBlocks[index].block) << "\r\n dropping connection";
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
       return 1;
     }
 
-    cachedBlocks.emplace_back(blockTemplates[index]);
     if (index == 1) {
-      if (m_core.hasBlock(cachedBlocks.back().getBlockHash())) { //TODO
+      if (m_core.hasBlock(cachedBlocks[index].getBlockHash())) { //TODO
         context.m_state = CryptoNoteConnectionContext::state_idle;
         context.m_needed_objects.clear();
         context.m_requested_objects.clear();
@@ -466,18 +519,18 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
       }
     }
 
-    auto req_it = context.m_requested_objects.find(cachedBlocks.back().getBlockHash());
+    auto req_it = context.m_requested_objects.find(cachedBlocks[index].getBlockHash());
     if (req_it == context.m_requested_objects.end()) {
-      logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << Common::podToHex(cachedBlocks.back().getBlockHash())
+      logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << Common::podToHex(cachedBlocks[index].getBlockHash())
         << " wasn't requested, dropping connection";
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
       return 1;
     }
 
-    if (cachedBlocks.back().getBlock().transactionHashes.size() != rawBlocks[index].transactions.size()) {
+    if (cachedBlocks[index].getBlock().transactionHashes.size() != rawBlocks[index].transactions.size()) {
       logger(Logging::ERROR) << context
-        << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << Common::podToHex(cachedBlocks.back().getBlockHash())
-        << ", transactionHashes.size()=" << cachedBlocks.back().getBlock().transactionHashes.size()
+        << "sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << Common::podToHex(cachedBlocks[index].getBlockHash())
+        << ", transactionHashes.size()=" << cachedBlocks[index].getBlock().transactionHashes.size()
         << " mismatch with block_complete_entry.m_txs.size()=" << rawBlocks[index].transactions.size()
         << ", dropping connection";
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
@@ -495,6 +548,11 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
     return 1;
   }
 
+  // Ask for the next batch before adding this one, so it's downloaded while these blocks are validated
+  if (!m_stop && !context.m_needed_objects.empty()) {
+    request_missing_objects(context, true);
+  }
+
   {
     int result = processObjects(context, std::move(rawBlocks), cachedBlocks);
     if (result != 0) {
@@ -503,7 +561,7 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
   }
 
   logger(DEBUGGING, BRIGHT_BLUE) << "Local blockchain updated, new index = " << m_core.getTopBlockIndex();
-  if (!m_stop && context.m_state == CryptoNoteConnectionContext::state_synchronizing) {
+  if (!m_stop && context.m_state == CryptoNoteConnectionContext::state_synchronizing && context.m_requested_objects.empty()) {
     request_missing_objects(context, true);
   }
 
@@ -36,6 +36,7 @@ namespace CryptoNote {
     void setStatus(HTTP_STATUS s);
     void addHeader(const std::string& name, const std::string& value);
     void setBody(const std::string& b);
+    void setBody(std::string&& b);
 
     const std::map<std::string, std::string>& getHeaders() const { return headers; }
     HTTP_STATUS getStatus() const { return status; }
@@ -90,6 +90,10 @@ void CommonLogger::setMaxLevel(Level level) {
   logLevel = level;
 }
 
+Level CommonLogger::getMaxLevel() const {
+  return logLevel;
+}
+
 CommonLogger::CommonLogger(Level level) : logLevel(level), pattern("%D %T %L [%C] ") {
 }
 
@@ -22,6 +22,11 @@ namespace Logging {
 FileLogger::FileLogger(Level level) : StreamLogger(level) {
 }
 
+FileLogger::~FileLogger() {
+  // The writer thread must be done with fileStream before it is closed
+  stopWriting();
+}
+
 void FileLogger::init(const std::string& fileName) {
   fileStream.open(fileName, std::ios::app);
   StreamLogger::attachToStream(fileStream);
@@ -57,6 +57,12 @@ public:
   const static std::array<std::string, 6> LEVEL_NAMES;
 
   virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) = 0;
+
+  /* Most verbose level that can get written anywhere, messages above it are
+     dropped before they are formatted */
+  virtual Level getMaxLevel() const {
+    return TRACE;
+  }
 };
 
 #ifndef ENDL
@@ -39,4 +39,13 @@ void LoggerGroup::operator()(const std::string& category, Level level, boost::po
   }
 }
 
+Level LoggerGroup::getMaxLevel() const {
+  Level maxLevel = FATAL;
+  for (auto& logger : loggers) {
+    maxLevel = std::max(maxLevel, logger->getMaxLevel());
+  }
+
+  return std::min(maxLevel, logLevel);
+}
+
 }
@@ -24,7 +24,7 @@ namespace Logging {
 
 using Common::JsonValue;
 
-LoggerManager::LoggerManager() {
+LoggerManager::LoggerManager() : maxLevel(LoggerGroup::getMaxLevel()) {
 }
 
 void LoggerManager::operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) {
@@ -32,6 +32,28 @@ void LoggerManager::operator()(const std::string& category, Level level, boost::
   LoggerGroup::operator()(category, level, time, body);
 }
 
+void LoggerManager::addLogger(ILogger& logger) {
+  std::unique_lock<std::mutex> lock(reconfigureLock);
+  LoggerGroup::addLogger(logger);
+  maxLevel = LoggerGroup::getMaxLevel();
+}
+
+void LoggerManager::removeLogger(ILogger& logger) {
+  std::unique_lock<std::mutex> lock(reconfigureLock);
+  LoggerGroup::removeLogger(logger);
+  maxLevel = LoggerGroup::getMaxLevel();
+}
+
+void LoggerManager::setMaxLevel(Level level) {
+  std::unique_lock<std::mutex> lock(reconfigureLock);
+  LoggerGroup::setMaxLevel(level);
+  maxLevel = LoggerGroup::getMaxLevel();
+}
+
+Level LoggerManager::getMaxLevel() const {
+  return maxLevel;
+}
+
 void LoggerManager::configure(const JsonValue& val) {
   std::unique_lock<std::mutex> lock(reconfigureLock);
   loggers.clear();
@@ -110,7 +132,7 @@ void LoggerManager::configure(const JsonValue& val) {
         }
 
         loggers.emplace_back(std::move(logger));
-        addLogger(*loggers.back());
+        LoggerGroup::addLogger(*loggers.back());
       }
     } else {
       throw std::runtime_error("loggers parameter has wrong type");
@@ -118,10 +140,12 @@ void LoggerManager::configure(const JsonValue& val) {
   } else {
     throw std::runtime_error("loggers parameter missing");
   }
-  setMaxLevel(globalLevel);
+  LoggerGroup::setMaxLevel(globalLevel);
   for (const auto& category : globalDisabledCategories) {
     disableCategory(category);
   }
+
+  maxLevel = LoggerGroup::getMaxLevel();
 }
 
 }
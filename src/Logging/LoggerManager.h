@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -30,10 +31,16 @@ public:
   LoggerManager();
   void configure(const Common::JsonValue& val);
   virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) override;
+  virtual void addLogger(ILogger& logger) override;
+  virtual void removeLogger(ILogger& logger) override;
+  virtual void setMaxLevel(Level level) override;
+  virtual Level getMaxLevel() const override;
 
 private:
   std::vector<std::unique_ptr<CommonLogger>> loggers;
   std::mutex reconfigureLock;
+  // Checked for every message, so it is kept up to date instead of asking the loggers under the lock
+  std::atomic<Level> maxLevel;
 };
 
 }
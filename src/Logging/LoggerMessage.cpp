@@ -22,12 +22,16 @@ namespace Logging {
 LoggerMessage::LoggerMessage(ILogger& logger, const std::string& category, Level level, const std::string& color)
   : std::ostream(this)
   , std::streambuf()
+  , enabled(level <= logger.getMaxLevel())
   , logger(logger)
-  , category(category)
+  , category(enabled ? category : std::string())
   , logLevel(level)
-  , message(color)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
+  , message(enabled ? color : std::string())
+  , timestamp(enabled ? boost::posix_time::microsec_clock::local_time() : boost::posix_time::ptime())
   , gotText(false) {
+  if (!enabled) {
+    setstate(std::ios::badbit);
+  }
 }
 
 LoggerMessage::~LoggerMessage() {
@@ -40,11 +44,12 @@ LoggerMessage::~LoggerMessage() {
 LoggerMessage::LoggerMessage(LoggerMessage&& other)
   : std::ostream(std::move(other))
   , std::streambuf(std::move(other))
+  , enabled(other.enabled)
   , category(other.category)
   , logLevel(other.logLevel)
   , logger(other.logger)
   , message(other.message)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
+  , timestamp(other.timestamp)
   , gotText(false) {
   this->set_rdbuf(this);
 }
@@ -52,11 +57,12 @@ LoggerMessage::LoggerMessage(LoggerMessage&& other)
 LoggerMessage::LoggerMessage(LoggerMessage&& other)
   : std::ostream(nullptr)
   , std::streambuf()
+  , enabled(other.enabled)
   , category(other.category)
   , logLevel(other.logLevel)
   , logger(other.logger)
   , message(other.message)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
+  , timestamp(other.timestamp)
   , gotText(false) {
   if (this != &other) {
     _M_tie = nullptr;
@@ -99,6 +105,10 @@ LoggerMessage::LoggerMessage(LoggerMessage&& other)
 #endif
 
 int LoggerMessage::sync() {
+  if (!enabled) {
+    return 0;
+  }
+
   logger(category, logLevel, timestamp, message);
   gotText = false;
   message = DEFAULT;
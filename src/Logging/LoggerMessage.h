@@ -35,6 +35,8 @@ private:
   std::streamsize xsputn(const char* s, std::streamsize n) override;
   int overflow(int c) override;
 
+  // Disabled messages keep the stream in a failed state, so nothing put into them gets formatted
+  const bool enabled;
   std::string message;
   const std::string category;
   Level logLevel;
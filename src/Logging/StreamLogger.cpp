@@ -15,36 +15,182 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
+
 #include "StreamLogger.h"
 #include <iostream>
 #include <sstream>
 
 namespace Logging {
 
-StreamLogger::StreamLogger(Level level) : CommonLogger(level), stream(nullptr) {
+namespace {
+
+const size_t MESSAGE_QUEUE_SIZE = 4096;
+const size_t MAX_MESSAGES_PER_WRITE = 256;
+
+void appendText(const std::string& message, std::string& text) {
+  bool readingText = true;
+  size_t runStart = 0;
+  for (size_t charPos = 0; charPos < message.size(); ++charPos) {
+    if (message[charPos] == ILogger::COLOR_DELIMETER) {
+      if (readingText) {
+        text.append(message, runStart, charPos - runStart);
+      }
+
+      readingText = !readingText;
+      runStart = charPos + 1;
+    }
+  }
+
+  if (readingText) {
+    text.append(message, runStart, std::string::npos);
+  }
+}
+
+}
+
+StreamLogger::StreamLogger(Level level) : CommonLogger(level), stream(nullptr), messages(MESSAGE_QUEUE_SIZE),
+  writerIdle(false), writerRunning(false), stopRequested(false), stopping(false) {
+}
+
+StreamLogger::StreamLogger(std::ostream& stream, Level level) : CommonLogger(level), stream(&stream), messages(MESSAGE_QUEUE_SIZE),
+  writerIdle(false), writerRunning(false), stopRequested(false), stopping(false) {
 }
 
-StreamLogger::StreamLogger(std::ostream& stream, Level level) : CommonLogger(level), stream(&stream) {
+StreamLogger::~StreamLogger() {
+  stopWriting();
 }
 
 void StreamLogger::attachToStream(std::ostream& stream) {
+  std::lock_guard<std::mutex> lock(mutex);
   this->stream = &stream;
 }
 
+void StreamLogger::operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) {
+  CommonLogger::operator()(category, level, time, body);
+
+  // The queue holds at most MESSAGE_QUEUE_SIZE messages, so this one is among them
+  if (level <= ERROR) {
+    writeQueued(MESSAGE_QUEUE_SIZE);
+  }
+}
+
 void StreamLogger::doLogString(const std::string& message) {
-  if (stream != nullptr && stream->good()) {
-    std::lock_guard<std::mutex> lock(mutex);
-    bool readingText = true;
-    for (size_t charPos = 0; charPos < message.size(); ++charPos) {
-      if (message[charPos] == ILogger::COLOR_DELIMETER) {
-        readingText = !readingText;
-      } else if (readingText) {
-        *stream << message[charPos];
-      }
+  if (stopping) {
+    return;
+  }
+
+  if (!writerRunning) {
+    startWriter();
+  }
+
+  // The writer is woken up to make room, the message isn't dropped
+  while (!messages.tryPush(message)) {
+    if (!writerRunning) {
+      startWriter();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(wakeMutex);
+      wakeCondition.notify_one();
+    }
+
+    std::this_thread::yield();
+  }
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (writerIdle) {
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    wakeCondition.notify_one();
+  }
+
+  // Suspended after this thread saw the writer running, it may have missed the message
+  if (!writerRunning) {
+    writeQueued(MESSAGE_QUEUE_SIZE);
+  }
+}
+
+void StreamLogger::suspendWriting() {
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    if (!writerRunning || stopRequested) {
+      return;
+    }
+
+    stopRequested = true;
+    wakeCondition.notify_one();
+  }
+
+  writer.join();
+
+  /* Messages pushed after the writer's last look at the queue. A producer
+     checks writerRunning after its push, so either it or this sees them */
+  std::lock_guard<std::mutex> lock(wakeMutex);
+  writerRunning = false;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  writeQueued(MESSAGE_QUEUE_SIZE);
+}
+
+void StreamLogger::stopWriting() {
+  stopping = true;
+  suspendWriting();
+}
+
+void StreamLogger::startWriter() {
+  std::lock_guard<std::mutex> lock(wakeMutex);
+  if (writerRunning || stopping) {
+    return;
+  }
+
+  writerIdle = false;
+  stopRequested = false;
+  writer = std::thread(&StreamLogger::writerProcedure, this);
+  writerRunning = true;
+}
+
+void StreamLogger::writerProcedure() {
+  for (;;) {
+    if (writeQueued(MAX_MESSAGES_PER_WRITE) > 0) {
+      continue;
+    }
+
+    /* The producer checks writerIdle after its push, and this checks the
+       queue after setting it, so one of them sees the other */
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    writerIdle = true;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (writeQueued(MAX_MESSAGES_PER_WRITE) > 0) {
+      writerIdle = false;
+      continue;
+    }
+
+    if (stopRequested) {
+      break;
     }
 
-    *stream << std::flush;
+    wakeCondition.wait(lock);
+    writerIdle = false;
   }
 }
 
+// Popped and written under one lock, so messages written by other threads keep their order
+size_t StreamLogger::writeQueued(size_t maxCount) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  std::string message;
+  std::string batch;
+  size_t count = 0;
+  while (count < maxCount && messages.tryPop(message)) {
+    appendText(message, batch);
+    ++count;
+  }
+
+  if (count > 0 && stream != nullptr && stream->good()) {
+    stream->write(batch.data(), batch.size());
+    stream->flush();
+  }
+
+  return count;
+}
+
 }
@@ -15,27 +15,59 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
+
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 #include "CommonLogger.h"
+#include "../Common/RingBuffer.h"
 
 namespace Logging {
 
+/* Messages are queued without locking and written out by a background
+   thread, which joins whatever has piled up into one write and flush.
+   The thread is started by the first message. Errors are written out
+   before the call returns, they often come right before a crash */
 class StreamLogger : public CommonLogger {
 public:
   StreamLogger(Level level = DEBUGGING);
   StreamLogger(std::ostream& stream, Level level = DEBUGGING);
+  ~StreamLogger();
   void attachToStream(std::ostream& stream);
 
+  virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) override;
+
+  /* Writes out the queued messages and stops the writer thread until the
+     next message. Threads don't survive fork(), so it is called before */
+  void suspendWriting();
+
 protected:
   virtual void doLogString(const std::string& message) override;
 
+  /* Writes out the queued messages and stops the writer thread. Loggers
+     owning their stream call it before the stream is destroyed */
+  void stopWriting();
+
 protected:
   std::ostream* stream;
 
 private:
+  void startWriter();
+  void writerProcedure();
+  size_t writeQueued(size_t maxCount);
+
   std::mutex mutex;
+  Common::RingBuffer<std::string> messages;
+  std::mutex wakeMutex;
+  std::condition_variable wakeCondition;
+  std::atomic<bool> writerIdle;
+  std::atomic<bool> writerRunning;
+  std::atomic<bool> stopRequested;
+  std::atomic<bool> stopping;
+  std::thread writer;
 };
 
 }
@@ -11,6 +11,7 @@
 #include "Common/StringTools.h"
 
 #include "crypto/crypto.h"
+#include "crypto/hash.h"
 #include "CryptoNoteCore/CachedBlock.h"
 #include "CryptoNoteCore/CheckDifficulty.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
@@ -19,6 +20,13 @@
 
 namespace CryptoNote {
 
+namespace {
+
+/* Hashes computed per call into the block, between checks of the mining state */
+const size_t NONCES_PER_BATCH = 16;
+
+}
+
 Miner::Miner(System::Dispatcher& dispatcher, Logging::ILogger& logger) :
   m_dispatcher(dispatcher),
   m_miningStopped(dispatcher),
@@ -91,31 +99,44 @@ void Miner::runWorkers(BlockMiningParameters blockMiningParameters, size_t threa
 }
 
 void Miner::workerFunc(const BlockTemplate& blockTemplate, uint64_t difficulty, uint32_t nonceStep) {
+  /* The scratchpad is kept for the whole run instead of being mapped for every hash */
+  Crypto::slow_hash_reserve_state(CN_PAGE_SIZE);
+
   try {
     BlockTemplate block = blockTemplate;
+    CachedBlock cachedBlock(block);
+    uint32_t nonce = block.nonce;
+    std::vector<Crypto::Hash> hashes(NONCES_PER_BATCH);
 
     while (m_state == MiningState::MINING_IN_PROGRESS) {
-      CachedBlock cachedBlock(block);
-      Crypto::Hash hash = cachedBlock.getBlockLongHash();
-      if (check_hash(hash, difficulty)) {
-        m_logger(Logging::INFO) << "Found block for difficulty " << difficulty;
+      cachedBlock.getBlockLongHashes(nonce, nonceStep, hashes.size(), hashes.data());
 
-        if (!setStateBlockFound()) {
-          m_logger(Logging::DEBUGGING) << "block is already found or mining stopped";
+      for (size_t i = 0; i < hashes.size(); ++i) {
+        if (check_hash(hashes[i], difficulty)) {
+          m_logger(Logging::INFO) << "Found block for difficulty " << difficulty;
+
+          if (!setStateBlockFound()) {
+            m_logger(Logging::DEBUGGING) << "block is already found or mining stopped";
+            Crypto::slow_hash_release_state();
+            return;
+          }
+
+          block.nonce = nonce + static_cast<uint32_t>(i) * nonceStep;
+          m_block = block;
+          Crypto::slow_hash_release_state();
           return;
         }
-
-        m_block = block;
-        return;
       }
 
-      incrementHashCount();
-      block.nonce += nonceStep;
+      incrementHashCount(hashes.size());
+      nonce += static_cast<uint32_t>(hashes.size()) * nonceStep;
     }
   } catch (std::exception& e) {
     m_logger(Logging::ERROR) << "Miner got error: " << e.what();
     m_state = MiningState::MINING_STOPPED;
   }
+
+  Crypto::slow_hash_release_state();
 }
 
 bool Miner::setStateBlockFound() {
@@ -142,9 +163,9 @@ bool Miner::setStateBlockFound() {
   }
 }
 
-void Miner::incrementHashCount() {
+void Miner::incrementHashCount(uint64_t hashCount) {
   std::lock_guard<std::mutex> guard(m_hashes_mutex);
-  m_hash_count++;
+  m_hash_count += hashCount;
 }
 
 uint64_t Miner::getHashCount() {
@@ -54,7 +54,7 @@ private:
   void runWorkers(BlockMiningParameters blockMiningParameters, size_t threadCount);
   void workerFunc(const BlockTemplate& blockTemplate, uint64_t difficulty, uint32_t nonceStep);
   bool setStateBlockFound();
-  void incrementHashCount();
+  void incrementHashCount(uint64_t hashCount);
 };
 
 } //namespace CryptoNote
@@ -16,8 +16,6 @@
 #include <HTTP/HttpResponse.h>
 #include <System/ContextGroup.h>
 #include <System/Dispatcher.h>
-#include <System/Event.h>
-#include <System/EventLock.h>
 #include <System/Timer.h>
 #include <CryptoNoteCore/TransactionApi.h>
 
@@ -26,7 +24,7 @@
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "Rpc/CoreRpcServerCommandsDefinitions.h"
-#include "Rpc/HttpClient.h"
+#include "Rpc/HttpClientPool.h"
 #include "Rpc/JsonRpc.h"
 
 #ifndef AUTO_VAL_INIT
@@ -42,6 +40,9 @@ namespace CryptoNote {
 
 namespace {
 
+// Connections kept open to the node, so sync requests and sends don't wait for each other
+const size_t NODE_CONNECTION_COUNT = 4;
+
 std::error_code interpretResponseStatus(const std::string& status) {
   if (CORE_RPC_STATUS_BUSY == status) {
     return make_error_code(error::NODE_BUSY);
@@ -51,6 +52,33 @@ std::error_code interpretResponseStatus(const std::string& status) {
   return std::error_code();
 }
 
+std::error_code makeBlockShortEntries(std::vector<BlockShortInfo>& items, std::vector<BlockShortEntry>& entries) {
+  for (auto& item: items) {
+    BlockShortEntry bse;
+    bse.hasBlock = false;
+
+    bse.blockHash = std::move(item.blockId);
+    if (!item.block.empty()) {
+      if (!fromBinaryArray(bse.block, item.block)) {
+        return std::make_error_code(std::errc::invalid_argument);
+      }
+
+      bse.hasBlock = true;
+    }
+
+    for (const auto& txp: item.txPrefixes) {
+      TransactionShortInfo tsi;
+      tsi.txId = txp.txHash;
+      tsi.txPrefix = txp.txPrefix;
+      bse.txsShortInfo.push_back(std::move(tsi));
+    }
+
+    entries.push_back(std::move(bse));
+  }
+
+  return std::error_code();
+}
+
 }
 
 NodeRpcProxy::NodeRpcProxy(const std::string& nodeHost, unsigned short nodePort, Logging::ILogger& logger) :
@@ -76,6 +104,8 @@ NodeRpcProxy::~NodeRpcProxy() {
 
 void NodeRpcProxy::resetInternalState() {
   m_stop = false;
+  m_binarySyncSupported = true;
+  m_blockFiltersSupported = true;
   m_peerCount.store(0, std::memory_order_relaxed);
   m_networkHeight.store(0, std::memory_order_relaxed);
   lastLocalBlockHeaderInfo.index = 0;
@@ -123,11 +153,8 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
     m_dispatcher = &dispatcher;
     ContextGroup contextGroup(dispatcher);
     m_context_group = &contextGroup;
-    HttpClient httpClient(dispatcher, m_nodeHost, m_nodePort);
-    m_httpClient = &httpClient;
-    Event httpEvent(dispatcher);
-    m_httpEvent = &httpEvent;
-    m_httpEvent->set();
+    HttpClientPool httpClients(dispatcher, m_nodeHost, m_nodePort, NODE_CONNECTION_COUNT);
+    m_httpClients = &httpClients;
 
     {
       std::lock_guard<std::mutex> lock(m_mutex);
@@ -160,8 +187,7 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
 
   m_dispatcher = nullptr;
   m_context_group = nullptr;
-  m_httpClient = nullptr;
-  m_httpEvent = nullptr;
+  m_httpClients = nullptr;
   m_connected = false;
   m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
 }
@@ -251,8 +277,8 @@ void NodeRpcProxy::updateBlockchainStatus() {
     updatePeerCount(getInfoResp.incoming_connections_count + getInfoResp.outgoing_connections_count);
   }
 
-  if (m_connected != m_httpClient->isConnected()) {
-    m_connected = m_httpClient->isConnected();
+  if (m_connected != m_httpClients->isConnected()) {
+    m_connected = m_httpClients->isConnected();
     m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
   }
 }
@@ -464,6 +490,28 @@ void NodeRpcProxy::queryBlocks(std::vector<Crypto::Hash>&& knownBlockIds, uint64
           std::ref(newBlocks), std::ref(startHeight)), callback);
 }
 
+void NodeRpcProxy::queryBlockFilters(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<BlockFilter>& filters,
+  uint32_t& startHeight, const Callback& callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_state != STATE_INITIALIZED) {
+    callback(make_error_code(error::NOT_INITIALIZED));
+    return;
+  }
+
+  scheduleRequest(std::bind(&NodeRpcProxy::doQueryBlockFilters, this, std::move(knownBlockIds), timestamp,
+          std::ref(filters), std::ref(startHeight)), callback);
+}
+
+void NodeRpcProxy::getBlocksLite(std::vector<Crypto::Hash>&& blockHashes, std::vector<BlockShortEntry>& blocks, const Callback& callback) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_state != STATE_INITIALIZED) {
+    callback(make_error_code(error::NOT_INITIALIZED));
+    return;
+  }
+
+  scheduleRequest(std::bind(&NodeRpcProxy::doGetBlocksLite, this, std::move(blockHashes), std::ref(blocks)), callback);
+}
+
 void NodeRpcProxy::getPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
         std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds, const Callback& callback) {
   std::lock_guard<std::mutex> lock(m_mutex);
@@ -569,7 +617,7 @@ std::error_code NodeRpcProxy::doGetNewBlocks(std::vector<Crypto::Hash>& knownBlo
   req.block_ids = std::move(knownBlockIds);
 
   m_logger(TRACE) << "Send getblocks request";
-  std::error_code ec = jsonCommand("/getblocks", req, rsp);
+  std::error_code ec = syncCommand("/getblocks", req, rsp);
   if (!ec) {
     m_logger(TRACE) << "getblocks complete, start_height " << rsp.start_height << ", block count " << rsp.blocks.size();
     newBlocks = std::move(rsp.blocks);
@@ -588,7 +636,7 @@ std::error_code NodeRpcProxy::doGetTransactionOutsGlobalIndices(const Crypto::Ha
   req.txid = transactionHash;
 
   m_logger(TRACE) << "Send get_o_indexes request, transaction " << req.txid;
-  std::error_code ec = jsonCommand("/get_o_indexes", req, rsp);
+  std::error_code ec = syncCommand("/get_o_indexes", req, rsp);
   if (!ec) {
     m_logger(TRACE) << "get_o_indexes complete";
     outsGlobalIndices.clear();
@@ -611,7 +659,7 @@ std::error_code NodeRpcProxy::doQueryBlocksLite(const std::vector<Crypto::Hash>&
   req.timestamp = timestamp;
 
   m_logger(TRACE) << "Send queryblockslite request, timestamp " << req.timestamp;
-  std::error_code ec = jsonCommand("/queryblockslite", req, rsp);
+  std::error_code ec = syncCommand("/queryblockslite", req, rsp);
   if (ec) {
     m_logger(TRACE) << "queryblockslite failed: " << ec << ", " << ec.message();
     return ec;
@@ -620,32 +668,68 @@ std::error_code NodeRpcProxy::doQueryBlocksLite(const std::vector<Crypto::Hash>&
   m_logger(TRACE) << "queryblockslite complete, startHeight " << rsp.startHeight << ", block count " << rsp.items.size();
   startHeight = static_cast<uint32_t>(rsp.startHeight);
 
-  for (auto& item: rsp.items) {
-    BlockShortEntry bse;
-    bse.hasBlock = false;
+  return makeBlockShortEntries(rsp.items, newBlocks);
+}
 
-    bse.blockHash = std::move(item.blockId);
-    if (!item.block.empty()) {
-      if (!fromBinaryArray(bse.block, item.block)) {
-        return std::make_error_code(std::errc::invalid_argument);
-      }
+/* Block filters are only served as .bin, a node without them gets asked for
+   full blocks from then on */
+std::error_code NodeRpcProxy::doQueryBlockFilters(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp,
+        std::vector<BlockFilter>& filters, uint32_t& startHeight) {
+  if (!m_blockFiltersSupported) {
+    return make_error_code(error::NOT_SUPPORTED);
+  }
 
-      bse.hasBlock = true;
-    }
+  CryptoNote::COMMAND_RPC_QUERY_BLOCK_FILTERS::request req = AUTO_VAL_INIT(req);
+  CryptoNote::COMMAND_RPC_QUERY_BLOCK_FILTERS::response rsp = AUTO_VAL_INIT(rsp);
 
-    for (const auto& txp: item.txPrefixes) {
-      TransactionShortInfo tsi;
-      tsi.txId = txp.txHash;
-      tsi.txPrefix = txp.txPrefix;
-      bse.txsShortInfo.push_back(std::move(tsi));
-    }
+  req.blockIds = knownBlockIds;
+  req.timestamp = timestamp;
 
-    newBlocks.push_back(std::move(bse));
+  m_logger(TRACE) << "Send queryblockfilters request, timestamp " << req.timestamp;
+  std::error_code ec;
+  try {
+    ec = binaryCommand("/queryblockfilters.bin", req, rsp);
+  } catch (const NotFoundException&) {
+    m_logger(DEBUGGING) << "Node doesn't support block filters, using full blocks";
+    m_blockFiltersSupported = false;
+    return make_error_code(error::NOT_SUPPORTED);
   }
 
+  if (ec) {
+    m_logger(TRACE) << "queryblockfilters failed: " << ec << ", " << ec.message();
+    return ec;
+  }
+
+  m_logger(TRACE) << "queryblockfilters complete, startHeight " << rsp.startHeight << ", filter count " << rsp.items.size();
+  startHeight = static_cast<uint32_t>(rsp.startHeight);
+  filters = std::move(rsp.items);
+
   return std::error_code();
 }
 
+std::error_code NodeRpcProxy::doGetBlocksLite(const std::vector<Crypto::Hash>& blockHashes, std::vector<CryptoNote::BlockShortEntry>& blocks) {
+  CryptoNote::COMMAND_RPC_GET_BLOCKS_LITE::request req = AUTO_VAL_INIT(req);
+  CryptoNote::COMMAND_RPC_GET_BLOCKS_LITE::response rsp = AUTO_VAL_INIT(rsp);
+
+  req.blockIds = blockHashes;
+
+  m_logger(TRACE) << "Send getblockslite request, block count " << req.blockIds.size();
+  std::error_code ec;
+  try {
+    ec = binaryCommand("/getblockslite.bin", req, rsp);
+  } catch (const NotFoundException&) {
+    return make_error_code(error::NOT_SUPPORTED);
+  }
+
+  if (ec) {
+    m_logger(TRACE) << "getblockslite failed: " << ec << ", " << ec.message();
+    return ec;
+  }
+
+  m_logger(TRACE) << "getblockslite complete, block count " << rsp.items.size();
+  return makeBlockShortEntries(rsp.items, blocks);
+}
+
 std::error_code NodeRpcProxy::doGetPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
         std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds) {
   CryptoNote::COMMAND_RPC_GET_POOL_CHANGES_LITE::request req = AUTO_VAL_INIT(req);
@@ -780,8 +864,8 @@ void NodeRpcProxy::scheduleRequest(std::function<std::error_code()>&& procedure,
           callback(std::make_error_code(std::errc::operation_canceled));
         } else {
           std::error_code ec = procedure();
-          if (m_connected != m_httpClient->isConnected()) {
-            m_connected = m_httpClient->isConnected();
+          if (m_connected != m_httpClients->isConnected()) {
+            m_connected = m_httpClients->isConnected();
             m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
           }
           callback(m_stop ? std::make_error_code(std::errc::operation_canceled) : ec);
@@ -795,9 +879,10 @@ std::error_code NodeRpcProxy::binaryCommand(const std::string& url, const Reques
   std::error_code ec;
 
   try {
-    EventLock eventLock(*m_httpEvent);
-    invokeBinaryCommand(*m_httpClient, url, req, res);
+    invokeBinaryCommand(*m_httpClients, url, req, res);
     ec = interpretResponseStatus(res.status);
+  } catch (const NotFoundException&) {
+    throw;
   } catch (const ConnectException&) {
     ec = make_error_code(error::CONNECT_ERROR);
   } catch (const std::exception&) {
@@ -813,8 +898,7 @@ std::error_code NodeRpcProxy::jsonCommand(const std::string& url, const Request&
 
   try {
     m_logger(TRACE) << "Send " << url << " JSON request";
-    EventLock eventLock(*m_httpEvent);
-    invokeJsonCommand(*m_httpClient, url, req, res);
+    invokeJsonCommand(*m_httpClients, url, req, res);
     ec = interpretResponseStatus(res.status);
   } catch (const ConnectException&) {
     ec = make_error_code(error::CONNECT_ERROR);
@@ -831,13 +915,28 @@ std::error_code NodeRpcProxy::jsonCommand(const std::string& url, const Request&
   return ec;
 }
 
+/* Sync requests go to the .bin variant of the url, blobs aren't hex encoded there and
+   it is cheaper to parse. Nodes without it get the JSON request from then on */
+template <typename Request, typename Response>
+std::error_code NodeRpcProxy::syncCommand(const std::string& url, const Request& req, Response& res) {
+  if (m_binarySyncSupported) {
+    try {
+      return binaryCommand(url + ".bin", req, res);
+    } catch (const NotFoundException&) {
+      m_logger(DEBUGGING) << "Node doesn't support binary sync requests, using JSON";
+      m_binarySyncSupported = false;
+    }
+  }
+
+  return jsonCommand(url, req, res);
+}
+
 template <typename Request, typename Response>
 std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Request& req, Response& res) {
   std::error_code ec = make_error_code(error::INTERNAL_NODE_ERROR);
 
   try {
     m_logger(TRACE) << "Send " << method << " JSON RPC request";
-    EventLock eventLock(*m_httpEvent);
 
     JsonRpc::JsonRpcRequest jsReq;
 
@@ -851,7 +950,7 @@ std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Re
     httpReq.setUrl("/json_rpc");
     httpReq.setBody(jsReq.getBody());
 
-    m_httpClient->request(httpReq, httpRes);
+    m_httpClients->request(httpReq, httpRes);
 
     JsonRpc::JsonRpcResponse jsRes;
 
@@ -20,12 +20,11 @@
 namespace System {
   class ContextGroup;
   class Dispatcher;
-  class Event;
 }
 
 namespace CryptoNote {
 
-class HttpClient;
+class HttpClientPool;
 
 class INodeRpcProxyObserver {
 public:
@@ -68,6 +67,8 @@ public:
   virtual void getNewBlocks(std::vector<Crypto::Hash>&& knownBlockIds, std::vector<CryptoNote::RawBlock>& newBlocks, uint32_t& startHeight, const Callback& callback) override;
   virtual void getTransactionOutsGlobalIndices(const Crypto::Hash& transactionHash, std::vector<uint32_t>& outsGlobalIndices, const Callback& callback) override;
   virtual void queryBlocks(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<BlockShortEntry>& newBlocks, uint32_t& startHeight, const Callback& callback) override;
+  virtual void queryBlockFilters(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<BlockFilter>& filters, uint32_t& startHeight, const Callback& callback) override;
+  virtual void getBlocksLite(std::vector<Crypto::Hash>&& blockHashes, std::vector<BlockShortEntry>& blocks, const Callback& callback) override;
   virtual void getPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
           std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds, const Callback& callback) override;
   virtual void getBlocks(const std::vector<uint32_t>& blockHeights, std::vector<std::vector<BlockDetails>>& blocks, const Callback& callback) override;
@@ -103,6 +104,9 @@ private:
                                                     std::vector<uint32_t>& outsGlobalIndices);
   std::error_code doQueryBlocksLite(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp,
     std::vector<CryptoNote::BlockShortEntry>& newBlocks, uint32_t& startHeight);
+  std::error_code doQueryBlockFilters(const std::vector<Crypto::Hash>& knownBlockIds, uint64_t timestamp,
+    std::vector<BlockFilter>& filters, uint32_t& startHeight);
+  std::error_code doGetBlocksLite(const std::vector<Crypto::Hash>& blockHashes, std::vector<CryptoNote::BlockShortEntry>& blocks);
   std::error_code doGetPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
           std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds);
   std::error_code doGetBlocksByHeight(const std::vector<uint32_t>& blockHeights, std::vector<std::vector<BlockDetails>>& blocks);
@@ -118,6 +122,8 @@ private:
   std::error_code jsonCommand(const std::string& url, const Request& req, Response& res);
   template <typename Request, typename Response>
   std::error_code jsonRpcCommand(const std::string& method, const Request& req, Response& res);
+  template <typename Request, typename Response>
+  std::error_code syncCommand(const std::string& url, const Request& req, Response& res);
 
   enum State {
     STATE_NOT_INITIALIZED,
@@ -139,8 +145,7 @@ private:
   const std::string m_nodeHost;
   const unsigned short m_nodePort;
   unsigned int m_rpcTimeout;
-  HttpClient* m_httpClient = nullptr;
-  System::Event* m_httpEvent = nullptr;
+  HttpClientPool* m_httpClients = nullptr;
 
   uint64_t m_pullInterval;
 
@@ -149,6 +154,10 @@ private:
   std::atomic<size_t> m_peerCount;
   std::atomic<uint32_t> m_networkHeight;
   std::atomic<uint64_t> m_nodeHeight;
+  // cleared once the node turns out not to serve the .bin sync requests
+  bool m_binarySyncSupported = true;
+  // cleared once the node turns out not to serve block filters
+  bool m_blockFiltersSupported = true;
 
   BlockHeaderInfo lastLocalBlockHeaderInfo;
   //protect it with mutex if decided to add worker threads
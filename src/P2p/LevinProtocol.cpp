@@ -60,15 +60,8 @@ void LevinProtocol::sendMessage(uint32_t command, const BinaryArray& out, bool n
   head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
   head.m_flags = LEVIN_PACKET_REQUEST;
 
-  // write header and body in one operation
-  BinaryArray writeBuffer;
-  writeBuffer.reserve(sizeof(head) + out.size());
-
-  Common::VectorOutputStream stream(writeBuffer);
-  stream.writeSome(&head, sizeof(head));
-  stream.writeSome(out.data(), out.size());
-
-  writeStrict(writeBuffer.data(), writeBuffer.size());
+  // write header and body in one operation, without copying the body
+  writeStrict(reinterpret_cast<const uint8_t*>(&head), sizeof(head), out.data(), out.size());
 }
 
 bool LevinProtocol::readCommand(Command& cmd) {
@@ -113,20 +106,18 @@ void LevinProtocol::sendReply(uint32_t command, const BinaryArray& out, int32_t
   head.m_flags = LEVIN_PACKET_RESPONSE;
   head.m_return_code = returnCode;
 
-  BinaryArray writeBuffer;
-  writeBuffer.reserve(sizeof(head) + out.size());
-
-  Common::VectorOutputStream stream(writeBuffer);
-  stream.writeSome(&head, sizeof(head));
-  stream.writeSome(out.data(), out.size());
-
-  writeStrict(writeBuffer.data(), writeBuffer.size());
+  writeStrict(reinterpret_cast<const uint8_t*>(&head), sizeof(head), out.data(), out.size());
 }
 
-void LevinProtocol::writeStrict(const uint8_t* ptr, size_t size) {
+void LevinProtocol::writeStrict(const uint8_t* header, size_t headerSize, const uint8_t* data, size_t size) {
   size_t offset = 0;
+  while (offset < headerSize) {
+    offset += m_conn.write(header + offset, headerSize - offset, data, size);
+  }
+
+  offset -= headerSize;
   while (offset < size) {
-    offset += m_conn.write(ptr + offset, size - offset);
+    offset += m_conn.write(data + offset, size - offset);
   }
 }
 
@@ -47,6 +47,15 @@ namespace CryptoNote
     };
 
     P2pMessage(Type type, uint32_t command, const BinaryArray& buffer, int32_t returnCode = 0) :
+      type(type), command(command), buffer(std::make_shared<const BinaryArray>(buffer)), returnCode(returnCode) {
+    }
+
+    P2pMessage(Type type, uint32_t command, BinaryArray&& buffer, int32_t returnCode = 0) :
+      type(type), command(command), buffer(std::make_shared<const BinaryArray>(std::move(buffer))), returnCode(returnCode) {
+    }
+
+    // the same payload can be queued on any number of connections without being copied
+    P2pMessage(Type type, uint32_t command, const std::shared_ptr<const BinaryArray>& buffer, int32_t returnCode = 0) :
       type(type), command(command), buffer(buffer), returnCode(returnCode) {
     }
 
@@ -55,12 +64,12 @@ namespace CryptoNote
     }
 
     size_t size() {
-      return buffer.size();
+      return buffer->size();
     }
 
     Type type;
     uint32_t command;
-    const BinaryArray buffer;
+    std::shared_ptr<const BinaryArray> buffer;
     int32_t returnCode;
   };
 
@@ -165,6 +174,7 @@ namespace CryptoNote
     virtual bool invoke_notify_to_peer(int command, const BinaryArray& req_buff, const CryptoNoteConnectionContext& context) override;
     virtual void for_each_connection(std::function<void(CryptoNote::CryptoNoteConnectionContext&, PeerIdType)> f) override;
     virtual void externalRelayNotifyToAll(int command, const BinaryArray& data_buff, const net_connection_id* excludeConnection) override;
+    void relayNotifyToAll(int command, const std::shared_ptr<const BinaryArray>& buffer, const net_connection_id* excludeConnection);
 
     //-----------------------------------------------------------------------------------------------
     bool handle_command_line(const boost::program_options::variables_map& vm);
@@ -20,6 +20,8 @@
 #include <arpa/inet.h>
 #include <cassert>
 #include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <System/ErrorMessage.h>
@@ -28,6 +30,31 @@
 
 namespace System {
 
+namespace {
+
+ssize_t sendBuffers(int connection, const uint8_t* header, size_t headerSize, const uint8_t* data, size_t size, int flags) {
+  iovec buffers[2];
+  size_t bufferCount = 0;
+  if (headerSize != 0) {
+    buffers[bufferCount].iov_base = const_cast<uint8_t*>(header);
+    buffers[bufferCount].iov_len = headerSize;
+    ++bufferCount;
+  }
+
+  if (size != 0) {
+    buffers[bufferCount].iov_base = const_cast<uint8_t*>(data);
+    buffers[bufferCount].iov_len = size;
+    ++bufferCount;
+  }
+
+  msghdr message = {};
+  message.msg_iov = buffers;
+  message.msg_iovlen = bufferCount;
+  return ::sendmsg(connection, &message, flags);
+}
+
+}
+
 TcpConnection::TcpConnection() : dispatcher(nullptr) {
 }
 
@@ -164,6 +191,10 @@ size_t TcpConnection::read(uint8_t* data, size_t size) {
 }
 
 std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
+  return write(nullptr, 0, data, size);
+}
+
+std::size_t TcpConnection::write(const uint8_t* header, size_t headerSize, const uint8_t* data, size_t size) {
   assert(dispatcher != nullptr);
   assert(contextPair.writeContext == nullptr);
   if (dispatcher->interrupted()) {
@@ -171,7 +202,7 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
   }
 
   std::string message;
-  if(size == 0) {
+  if(headerSize + size == 0) {
     if(shutdown(connection, SHUT_WR) == -1) {
       throw std::runtime_error("TcpConnection::write, shutdown failed, " + lastErrorMessage());
     }
@@ -179,7 +210,7 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
     return 0;
   }
 
-  ssize_t transferred = ::send(connection, (void *)data, size, MSG_NOSIGNAL);
+  ssize_t transferred = sendBuffers(connection, header, headerSize, data, size, MSG_NOSIGNAL);
   if (transferred == -1) {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wlogical-op"
@@ -245,11 +276,11 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
           throw std::runtime_error("TcpConnection::write, events & (EPOLLERR | EPOLLHUP) != 0");
         }
 
-        ssize_t transferred = ::send(connection, (void *)data, size, 0);
+        ssize_t transferred = sendBuffers(connection, header, headerSize, data, size, 0);
         if (transferred == -1) {
           message = "send failed, "  + lastErrorMessage();
         } else {
-          assert(transferred <= static_cast<ssize_t>(size));
+          assert(transferred <= static_cast<ssize_t>(headerSize + size));
           return transferred;
         }
       }
@@ -258,7 +289,7 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
     throw std::runtime_error("TcpConnection::write, " + message);
   }
 
-  assert(transferred <= static_cast<ssize_t>(size));
+  assert(transferred <= static_cast<ssize_t>(headerSize + size));
   return transferred;
 }
 
@@ -36,6 +36,8 @@ public:
   TcpConnection& operator=(TcpConnection&& other);
   std::size_t read(uint8_t* data, std::size_t size);
   std::size_t write(const uint8_t* data, std::size_t size);
+  // Writes the header and then the data in a single operation, returns the bytes written from both
+  std::size_t write(const uint8_t* header, std::size_t headerSize, const uint8_t* data, std::size_t size);
   std::pair<Ipv4Address, uint16_t> getPeerAddressAndPort() const;
 
 private:
@@ -22,6 +22,7 @@
 #include <sys/event.h>
 #include <sys/errno.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "Dispatcher.h"
@@ -31,6 +32,31 @@
 
 namespace System {
 
+namespace {
+
+ssize_t sendBuffers(int connection, const uint8_t* header, size_t headerSize, const uint8_t* data, size_t size, int flags) {
+  iovec buffers[2];
+  size_t bufferCount = 0;
+  if (headerSize != 0) {
+    buffers[bufferCount].iov_base = const_cast<uint8_t*>(header);
+    buffers[bufferCount].iov_len = headerSize;
+    ++bufferCount;
+  }
+
+  if (size != 0) {
+    buffers[bufferCount].iov_base = const_cast<uint8_t*>(data);
+    buffers[bufferCount].iov_len = size;
+    ++bufferCount;
+  }
+
+  msghdr message = {};
+  message.msg_iov = buffers;
+  message.msg_iovlen = bufferCount;
+  return ::sendmsg(connection, &message, flags);
+}
+
+}
+
 TcpConnection::TcpConnection() : dispatcher(nullptr) {
 }
 
@@ -145,6 +171,10 @@ size_t TcpConnection::read(uint8_t* data, size_t size) {
 }
 
 size_t TcpConnection::write(const uint8_t* data, size_t size) {
+  return write(nullptr, 0, data, size);
+}
+
+size_t TcpConnection::write(const uint8_t* header, size_t headerSize, const uint8_t* data, size_t size) {
   assert(dispatcher != nullptr);
   assert(writeContext == nullptr);
   if (dispatcher->interrupted()) {
@@ -152,7 +182,7 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
   }
 
   std::string message;
-  if (size == 0) {
+  if (headerSize + size == 0) {
     if (shutdown(connection, SHUT_WR) == -1) {
       throw std::runtime_error("TcpConnection::write, shutdown failed, " + lastErrorMessage());
     }
@@ -160,7 +190,7 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
     return 0;
   }
 
-  ssize_t transferred = ::send(connection, (void *)data, size, 0);
+  ssize_t transferred = sendBuffers(connection, header, headerSize, data, size, 0);
   if (transferred == -1) {
     if (errno != EAGAIN  && errno != EWOULDBLOCK) {
       message = "send failed, " + lastErrorMessage();
@@ -202,11 +232,11 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
           throw InterruptedException();
         }
 
-        ssize_t transferred = ::send(connection, (void *)data, size, 0);
+        ssize_t transferred = sendBuffers(connection, header, headerSize, data, size, 0);
         if (transferred == -1) {
           message = "send failed, " + lastErrorMessage();
         } else {
-          assert(transferred <= static_cast<ssize_t>(size));
+          assert(transferred <= static_cast<ssize_t>(headerSize + size));
           return transferred;
         }
       }
@@ -215,7 +245,7 @@ size_t TcpConnection::write(const uint8_t* data, size_t size) {
     throw std::runtime_error("TcpConnection::write, " + message);
   }
 
-  assert(transferred <= static_cast<ssize_t>(size));
+  assert(transferred <= static_cast<ssize_t>(headerSize + size));
   return transferred;
 }
 
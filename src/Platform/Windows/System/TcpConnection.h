@@ -35,6 +35,8 @@ public:
   TcpConnection& operator=(TcpConnection&& other);
   size_t read(uint8_t* data, size_t size);
   size_t write(const uint8_t* data, size_t size);
+  // Writes the header and then the data in a single operation, returns the bytes written from both
+  size_t write(const uint8_t* header, size_t headerSize, const uint8_t* data, size_t size);
   std::pair<Ipv4Address, uint16_t> getPeerAddressAndPort() const;
 
 private:
@@ -15,6 +15,7 @@
 
 #include "Serialization/SerializationOverloads.h"
 #include "Serialization/BlockchainExplorerDataSerialization.h"
+#include <CryptoNoteCore/BlockFilter.h>
 #include <CryptoNoteCore/ICoreDefinitions.h>
 
 namespace CryptoNote {
@@ -723,6 +724,54 @@ struct COMMAND_RPC_QUERY_BLOCKS_LITE {
   };
 };
 
+struct COMMAND_RPC_QUERY_BLOCK_FILTERS {
+  struct request {
+    std::vector<Crypto::Hash> blockIds;
+    uint64_t timestamp;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(blockIds);
+      KV_MEMBER(timestamp)
+    }
+  };
+
+  struct response {
+    std::string status;
+    uint64_t startHeight;
+    uint64_t currentHeight;
+    uint64_t fullOffset;
+    std::vector<BlockFilter> items;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(status)
+      KV_MEMBER(startHeight)
+      KV_MEMBER(currentHeight)
+      KV_MEMBER(fullOffset)
+      KV_MEMBER(items)
+    }
+  };
+};
+
+struct COMMAND_RPC_GET_BLOCKS_LITE {
+  struct request {
+    std::vector<Crypto::Hash> blockIds;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(blockIds);
+    }
+  };
+
+  struct response {
+    std::string status;
+    std::vector<BlockShortInfo> items;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(status)
+      KV_MEMBER(items)
+    }
+  };
+};
+
 struct COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS {
   struct request {
     std::vector<uint32_t> blockHeights;
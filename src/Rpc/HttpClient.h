@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <cassert>
 #include <memory>
 
 #include <HTTP/HttpRequest.h>
@@ -33,6 +34,12 @@ public:
   ConnectException(const std::string& whatArg);
 };
 
+// The server has no handler for the requested url, e.g. a daemon older than the request
+class NotFoundException : public std::runtime_error  {
+public:
+  NotFoundException(const std::string& whatArg);
+};
+
 class HttpClient {
 public:
 
@@ -55,8 +62,9 @@ private:
   std::unique_ptr<System::TcpStreambuf> m_streamBuf;
 };
 
-template <typename Request, typename Response>
-void invokeJsonCommand(HttpClient& client, const std::string& url, const Request& req, Response& res) {
+// Client is an HttpClient or an HttpClientPool
+template <typename Client, typename Request, typename Response>
+void invokeJsonCommand(Client& client, const std::string& url, const Request& req, Response& res) {
   HttpRequest hreq;
   HttpResponse hres;
 
@@ -74,15 +82,24 @@ void invokeJsonCommand(HttpClient& client, const std::string& url, const Request
   }
 }
 
-template <typename Request, typename Response>
-void invokeBinaryCommand(HttpClient& client, const std::string& url, const Request& req, Response& res) {
+template <typename Client, typename Request, typename Response>
+void invokeBinaryCommand(Client& client, const std::string& url, const Request& req, Response& res) {
   HttpRequest hreq;
   HttpResponse hres;
 
   hreq.setUrl(url);
   hreq.setBody(storeToBinaryKeyValue(req));
+  assert(isBinaryKeyValueRoundTrip(req, hreq.getBody()));
   client.request(hreq, hres);
 
+  if (hres.getStatus() == HttpResponse::STATUS_404) {
+    throw NotFoundException(url);
+  }
+
+  if (hres.getStatus() != HttpResponse::STATUS_200) {
+    throw std::runtime_error("HTTP status: " + std::to_string(hres.getStatus()));
+  }
+
   if (!loadFromBinaryKeyValue(res, hres.getBody())) {
     throw std::runtime_error("Failed to parse binary response");
   }
@@ -0,0 +1,69 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "HttpClientPool.h"
+
+#include <cassert>
+
+namespace CryptoNote {
+
+HttpClientPool::HttpClientPool(System::Dispatcher& dispatcher, const std::string& address, uint16_t port, size_t maxConnections) :
+  m_dispatcher(dispatcher),
+  m_address(address),
+  m_port(port),
+  m_maxConnections(maxConnections),
+  m_clientCount(0),
+  m_connected(false),
+  m_clientReleased(dispatcher) {
+  assert(maxConnections > 0);
+}
+
+void HttpClientPool::request(const HttpRequest& req, HttpResponse& res) {
+  std::unique_ptr<HttpClient> client = takeClient();
+
+  try {
+    client->request(req, res);
+  } catch (const std::exception&) {
+    m_connected = client->isConnected();
+    if (!m_connected) {
+      // The server went away, the idle connections are most likely closed too
+      m_clientCount -= m_idleClients.size();
+      m_idleClients.clear();
+    }
+
+    releaseClient(std::move(client));
+    throw;
+  }
+
+  m_connected = client->isConnected();
+  releaseClient(std::move(client));
+}
+
+bool HttpClientPool::isConnected() const {
+  return m_connected;
+}
+
+std::unique_ptr<HttpClient> HttpClientPool::takeClient() {
+  while (m_idleClients.empty() && m_clientCount >= m_maxConnections) {
+    m_clientReleased.clear();
+    m_clientReleased.wait();
+  }
+
+  if (!m_idleClients.empty()) {
+    std::unique_ptr<HttpClient> client = std::move(m_idleClients.back());
+    m_idleClients.pop_back();
+    return client;
+  }
+
+  std::unique_ptr<HttpClient> client(new HttpClient(m_dispatcher, m_address, m_port));
+  ++m_clientCount;
+  return client;
+}
+
+void HttpClientPool::releaseClient(std::unique_ptr<HttpClient> client) {
+  m_idleClients.push_back(std::move(client));
+  m_clientReleased.set();
+}
+
+}
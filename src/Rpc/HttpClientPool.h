@@ -0,0 +1,47 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <System/Event.h>
+
+#include "HttpClient.h"
+
+namespace CryptoNote {
+
+/* Keep-alive connections to one server, shared by the contexts of a
+   dispatcher. Each request gets a connection of its own, so a slow request
+   doesn't hold up the ones sent after it. The server answers the requests
+   of a connection in order, which is why they aren't pipelined on one */
+class HttpClientPool {
+public:
+  HttpClientPool(System::Dispatcher& dispatcher, const std::string& address, uint16_t port, size_t maxConnections);
+  HttpClientPool(const HttpClientPool&) = delete;
+  HttpClientPool& operator=(const HttpClientPool&) = delete;
+
+  void request(const HttpRequest& req, HttpResponse& res);
+
+  // Whether the last finished request left its connection open
+  bool isConnected() const;
+
+private:
+  std::unique_ptr<HttpClient> takeClient();
+  void releaseClient(std::unique_ptr<HttpClient> client);
+
+  System::Dispatcher& m_dispatcher;
+  const std::string m_address;
+  const uint16_t m_port;
+  const size_t m_maxConnections;
+
+  size_t m_clientCount;
+  bool m_connected;
+  // most recently used last, its connection is the least likely to be closed
+  std::vector<std::unique_ptr<HttpClient>> m_idleClients;
+  System::Event m_clientReleased;
+};
+
+}
@@ -172,12 +172,26 @@ public:
 
   std::string getBody() {
     psResp.set("jsonrpc", std::string("2.0"));
-    return psResp.toString();
+    std::string body = psResp.toString();
+
+    if (!result.empty()) {
+      // members are written sorted by name and "result" goes after all the others
+      body.reserve(body.size() + result.size() + 11);
+      body.pop_back();
+      body += ",\"result\":";
+      body += result;
+      body += '}';
+    }
+
+    return body;
   }
 
+  // The result is kept as JSON text, results of block and transaction queries are too big to go through a JsonValue
   template <typename T>
   bool setResult(const T& v) {
-    psResp.set("result", storeToJsonValue(v));
+    result.clear();
+    Common::StringOutputStream stream(result);
+    storeToJson(v, stream);
     return true;
   }
 
@@ -193,6 +207,7 @@ public:
 
 private:
   Common::JsonValue psResp;
+  std::string result;
 };
 
 
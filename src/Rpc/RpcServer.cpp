@@ -6,11 +6,15 @@
 // Please see the included LICENSE file for more information.
 
 #include "RpcServer.h"
+#include <cassert>
 #include <future>
 #include <unordered_map>
 #include "math.h"
 
+#include <boost/scope_exit.hpp>
+
 // CryptoNote
+#include "Common/StringOutputStream.h"
 #include "Common/StringTools.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/Core.h"
@@ -18,6 +22,8 @@
 #include <config/CryptoNoteConfig.h>
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandlerCommon.h"
 #include "P2p/NetNode.h"
+#include <System/Event.h>
+#include <System/InterruptedException.h>
 #include "CoreRpcServerErrorCodes.h"
 #include "JsonRpc.h"
 #include "version.h"
@@ -37,10 +43,28 @@ static inline void serialize(COMMAND_RPC_GET_BLOCKS_FAST::response& response, IS
   KV_MEMBER(response.status)
 }
 
+/* Neither format holds arrays of arrays, each transaction goes as a binary string */
+static void serializeTransactionBlobs(std::vector<BinaryArray>& transactions, Common::StringView name, ISerializer& s) {
+  size_t size = transactions.size();
+  if (!s.beginArray(size, name)) {
+    transactions.clear();
+    return;
+  }
+
+  transactions.resize(size);
+  for (auto& transaction : transactions) {
+    std::string blob(transaction.begin(), transaction.end());
+    s.binary(blob, "");
+    transaction.assign(blob.begin(), blob.end());
+  }
+
+  s.endArray();
+}
+
 void serialize(BlockFullInfo& blockFullInfo, ISerializer& s) {
   KV_MEMBER(blockFullInfo.block_id);
   KV_MEMBER(blockFullInfo.block);
-  s(blockFullInfo.transactions, "txs");
+  serializeTransactionBlobs(blockFullInfo.transactions, "txs", s);
 }
 
 void serialize(TransactionPrefixInfo& transactionPrefixInfo, ISerializer& s) {
@@ -72,44 +96,79 @@ RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Comman
       response.addHeader("Access-Control-Allow-Origin", cors_domain);
     }
     response.addHeader("Content-Type", "application/json");
-    response.setBody(storeToJson(res.data()));
+
+    std::string body;
+    Common::StringOutputStream stream(body);
+    storeToJson(res.data(), stream);
+    response.setBody(std::move(body));
     return result;
   };
 }
 
+template <typename Command>
+RpcServer::HandlerFunction binMethod(bool (RpcServer::*handler)(typename Command::request const&, typename Command::response&)) {
+  return [handler](RpcServer* obj, const HttpRequest& request, HttpResponse& response) {
+
+    boost::value_initialized<typename Command::request> req;
+    boost::value_initialized<typename Command::response> res;
+
+    if (!loadFromBinaryKeyValue(static_cast<typename Command::request&>(req), request.getBody())) {
+      return false;
+    }
+
+    bool result = (obj->*handler)(req, res);
+    response.setBody(storeToBinaryKeyValue(res.data()));
+    assert(isBinaryKeyValueRoundTrip(res.data(), response.getBody()));
+    return result;
+  };
+}
 
 }
 
 std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction>> RpcServer::s_handlers = {
+  // binary handlers
+  { "/getblocks.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_FAST>(&RpcServer::on_get_blocks), false, true } },
+  { "/queryblocks.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS>(&RpcServer::on_query_blocks), false, true } },
+  { "/queryblockslite.bin", { binMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false, true } },
+  { "/queryblockfilters.bin", { binMethod<COMMAND_RPC_QUERY_BLOCK_FILTERS>(&RpcServer::on_query_block_filters), false, true } },
+  { "/getblockslite.bin", { binMethod<COMMAND_RPC_GET_BLOCKS_LITE>(&RpcServer::on_get_blocks_lite), false, true } },
+  { "/get_o_indexes.bin", { binMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false, true } },
+
   // json handlers
-  { "/getinfo", { jsonMethod<COMMAND_RPC_GET_INFO>(&RpcServer::on_get_info), true } },
-  { "/getheight", { jsonMethod<COMMAND_RPC_GET_HEIGHT>(&RpcServer::on_get_height), true } },
-  { "/gettransactions", { jsonMethod<COMMAND_RPC_GET_TRANSACTIONS>(&RpcServer::on_get_transactions), false } },
-  { "/sendrawtransaction", { jsonMethod<COMMAND_RPC_SEND_RAW_TX>(&RpcServer::on_send_raw_tx), false } },
+  { "/getinfo", { jsonMethod<COMMAND_RPC_GET_INFO>(&RpcServer::on_get_info), true, false } },
+  { "/getheight", { jsonMethod<COMMAND_RPC_GET_HEIGHT>(&RpcServer::on_get_height), true, false } },
+  { "/gettransactions", { jsonMethod<COMMAND_RPC_GET_TRANSACTIONS>(&RpcServer::on_get_transactions), false, true } },
+  { "/sendrawtransaction", { jsonMethod<COMMAND_RPC_SEND_RAW_TX>(&RpcServer::on_send_raw_tx), false, false } },
   // remove me in 2019
-  { "/feeinfo", { jsonMethod<COMMAND_RPC_GET_FEE_ADDRESS>(&RpcServer::on_get_fee_info), true } },
-  { "/getNodeFeeInfo", { jsonMethod<COMMAND_RPC_GET_FEE_ADDRESS>(&RpcServer::on_get_fee_info), true } },
-  { "/getpeers", { jsonMethod<COMMAND_RPC_GET_PEERS>(&RpcServer::on_get_peers), true } },
-  { "/getblocks", { jsonMethod<COMMAND_RPC_GET_BLOCKS_FAST>(&RpcServer::on_get_blocks), false } },
-  { "/queryblocks", { jsonMethod<COMMAND_RPC_QUERY_BLOCKS>(&RpcServer::on_query_blocks), false } },
-  { "/queryblockslite", { jsonMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false } },
-  { "/get_o_indexes", { jsonMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false } },
-  { "/getrandom_outs", { jsonMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs), false } },
-  { "/get_pool_changes", { jsonMethod<COMMAND_RPC_GET_POOL_CHANGES>(&RpcServer::onGetPoolChanges), false } },
-  { "/get_pool_changes_lite", { jsonMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite), false } },
-  { "/get_block_details_by_height", { jsonMethod<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HEIGHT>(&RpcServer::onGetBlockDetailsByHeight), false } },
-  { "/get_blocks_details_by_heights", { jsonMethod<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS>(&RpcServer::onGetBlocksDetailsByHeights), false } },
-  { "/get_blocks_details_by_hashes", { jsonMethod<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES>(&RpcServer::onGetBlocksDetailsByHashes), false } },
-  { "/get_blocks_hashes_by_timestamps", { jsonMethod<COMMAND_RPC_GET_BLOCKS_HASHES_BY_TIMESTAMPS>(&RpcServer::onGetBlocksHashesByTimestamps), false } },
-  { "/get_transaction_details_by_hashes", { jsonMethod<COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASHES>(&RpcServer::onGetTransactionDetailsByHashes), false } },
-  { "/get_transaction_hashes_by_payment_id", { jsonMethod<COMMAND_RPC_GET_TRANSACTION_HASHES_BY_PAYMENT_ID>(&RpcServer::onGetTransactionHashesByPaymentId), false } },
+  { "/feeinfo", { jsonMethod<COMMAND_RPC_GET_FEE_ADDRESS>(&RpcServer::on_get_fee_info), true, false } },
+  { "/getNodeFeeInfo", { jsonMethod<COMMAND_RPC_GET_FEE_ADDRESS>(&RpcServer::on_get_fee_info), true, false } },
+  { "/getpeers", { jsonMethod<COMMAND_RPC_GET_PEERS>(&RpcServer::on_get_peers), true, false } },
+  { "/getblocks", { jsonMethod<COMMAND_RPC_GET_BLOCKS_FAST>(&RpcServer::on_get_blocks), false, true } },
+  { "/queryblocks", { jsonMethod<COMMAND_RPC_QUERY_BLOCKS>(&RpcServer::on_query_blocks), false, true } },
+  { "/queryblockslite", { jsonMethod<COMMAND_RPC_QUERY_BLOCKS_LITE>(&RpcServer::on_query_blocks_lite), false, true } },
+  { "/queryblockfilters", { jsonMethod<COMMAND_RPC_QUERY_BLOCK_FILTERS>(&RpcServer::on_query_block_filters), false, true } },
+  { "/getblockslite", { jsonMethod<COMMAND_RPC_GET_BLOCKS_LITE>(&RpcServer::on_get_blocks_lite), false, true } },
+  { "/get_o_indexes", { jsonMethod<COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES>(&RpcServer::on_get_indexes), false, true } },
+  { "/getrandom_outs", { jsonMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs), false, true } },
+  { "/get_pool_changes", { jsonMethod<COMMAND_RPC_GET_POOL_CHANGES>(&RpcServer::onGetPoolChanges), false, true } },
+  { "/get_pool_changes_lite", { jsonMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite), false, true } },
+  { "/get_block_details_by_height", { jsonMethod<COMMAND_RPC_GET_BLOCK_DETAILS_BY_HEIGHT>(&RpcServer::onGetBlockDetailsByHeight), false, true } },
+  { "/get_blocks_details_by_heights", { jsonMethod<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS>(&RpcServer::onGetBlocksDetailsByHeights), false, true } },
+  { "/get_blocks_details_by_hashes", { jsonMethod<COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HASHES>(&RpcServer::onGetBlocksDetailsByHashes), false, true } },
+  { "/get_blocks_hashes_by_timestamps", { jsonMethod<COMMAND_RPC_GET_BLOCKS_HASHES_BY_TIMESTAMPS>(&RpcServer::onGetBlocksHashesByTimestamps), false, true } },
+  { "/get_transaction_details_by_hashes", { jsonMethod<COMMAND_RPC_GET_TRANSACTION_DETAILS_BY_HASHES>(&RpcServer::onGetTransactionDetailsByHashes), false, true } },
+  { "/get_transaction_hashes_by_payment_id", { jsonMethod<COMMAND_RPC_GET_TRANSACTION_HASHES_BY_PAYMENT_ID>(&RpcServer::onGetTransactionHashesByPaymentId), false, true } },
 
   // json rpc
-  { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } }
+  { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true, false } }
 };
 
-RpcServer::RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, Core& c, NodeServer& p2p, ICryptoNoteProtocolHandler& protocol) :
+RpcServer::RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, Core& c, NodeServer& p2p, ICryptoNoteProtocolHandler& protocol,
+                     size_t workerThreadCount) :
   HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocol(protocol) {
+  if (workerThreadCount != 0) {
+    m_workerPool.reset(new Common::ThreadPool(workerThreadCount));
+  }
 }
 
 void RpcServer::processRequest(const HttpRequest& request, HttpResponse& response) {
@@ -132,7 +191,11 @@ void RpcServer::processRequest(const HttpRequest& request, HttpResponse& respons
     return;
   }
 
-  it->second.handler(this, request, response);
+  if (it->second.readOnly) {
+    runReadOnly([&] { it->second.handler(this, request, response); });
+  } else {
+    it->second.handler(this, request, response);
+  }
 }
 
 bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse& response) {
@@ -153,18 +216,18 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
     jsonResponse.setId(jsonRequest.getId()); // copy id
 
     static std::unordered_map<std::string, RpcServer::RpcHandler<JsonMemberMethod>> jsonRpcHandlers = {
-      { "f_blocks_list_json", { makeMemberMethod(&RpcServer::f_on_blocks_list_json), false } },
-      { "f_block_json", { makeMemberMethod(&RpcServer::f_on_block_json), false } },
-      { "f_transaction_json", { makeMemberMethod(&RpcServer::f_on_transaction_json), false } },
-      { "f_on_transactions_pool_json", { makeMemberMethod(&RpcServer::f_on_transactions_pool_json), false } },
-      { "getblockcount", { makeMemberMethod(&RpcServer::on_getblockcount), true } },
-      { "on_getblockhash", { makeMemberMethod(&RpcServer::on_getblockhash), false } },
-      { "getblocktemplate", { makeMemberMethod(&RpcServer::on_getblocktemplate), false } },
-      { "getcurrencyid", { makeMemberMethod(&RpcServer::on_get_currency_id), true } },
-      { "submitblock", { makeMemberMethod(&RpcServer::on_submitblock), false } },
-      { "getlastblockheader", { makeMemberMethod(&RpcServer::on_get_last_block_header), false } },
-      { "getblockheaderbyhash", { makeMemberMethod(&RpcServer::on_get_block_header_by_hash), false } },
-      { "getblockheaderbyheight", { makeMemberMethod(&RpcServer::on_get_block_header_by_height), false } }
+      { "f_blocks_list_json", { makeMemberMethod(&RpcServer::f_on_blocks_list_json), false, true } },
+      { "f_block_json", { makeMemberMethod(&RpcServer::f_on_block_json), false, true } },
+      { "f_transaction_json", { makeMemberMethod(&RpcServer::f_on_transaction_json), false, true } },
+      { "f_on_transactions_pool_json", { makeMemberMethod(&RpcServer::f_on_transactions_pool_json), false, true } },
+      { "getblockcount", { makeMemberMethod(&RpcServer::on_getblockcount), true, true } },
+      { "on_getblockhash", { makeMemberMethod(&RpcServer::on_getblockhash), false, true } },
+      { "getblocktemplate", { makeMemberMethod(&RpcServer::on_getblocktemplate), false, true } },
+      { "getcurrencyid", { makeMemberMethod(&RpcServer::on_get_currency_id), true, false } },
+      { "submitblock", { makeMemberMethod(&RpcServer::on_submitblock), false, false } },
+      { "getlastblockheader", { makeMemberMethod(&RpcServer::on_get_last_block_header), false, true } },
+      { "getblockheaderbyhash", { makeMemberMethod(&RpcServer::on_get_block_header_by_hash), false, true } },
+      { "getblockheaderbyheight", { makeMemberMethod(&RpcServer::on_get_block_header_by_height), false, true } }
     };
 
     auto it = jsonRpcHandlers.find(jsonRequest.getMethod());
@@ -176,7 +239,11 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
       throw JsonRpcError(CORE_RPC_ERROR_CODE_CORE_BUSY, "Core is busy");
     }
 
-    it->second.handler(this, jsonRequest, jsonResponse);
+    if (it->second.readOnly) {
+      runReadOnly([&] { it->second.handler(this, jsonRequest, jsonResponse); });
+    } else {
+      it->second.handler(this, jsonRequest, jsonResponse);
+    }
 
   } catch (const JsonRpcError& err) {
     jsonResponse.setError(err);
@@ -184,8 +251,9 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
     jsonResponse.setError(JsonRpcError(JsonRpc::errInternalError, e.what()));
   }
 
-  response.setBody(jsonResponse.getBody());
-  logger(TRACE) << "JSON-RPC response: " << jsonResponse.getBody();
+  std::string body = jsonResponse.getBody();
+  logger(TRACE) << "JSON-RPC response: " << body;
+  response.setBody(std::move(body));
   return true;
 }
 
@@ -212,6 +280,42 @@ bool RpcServer::isCoreReady() {
   return m_core.getCurrency().isTestnet() || m_p2p.get_payload_object().isSynchronized();
 }
 
+void RpcServer::runReadOnly(const std::function<void()>& job) {
+  if (!m_workerPool) {
+    job();
+    return;
+  }
+
+  System::Event done(m_dispatcher);
+  System::Event* doneEvent = &done;
+
+  std::future<void> result = m_workerPool->addJob([this, &job, doneEvent] {
+    BOOST_SCOPE_EXIT_ALL(this, doneEvent) {
+      m_dispatcher.remoteSpawn([doneEvent] { doneEvent->set(); });
+    };
+
+    auto lock = m_core.lockForReading();
+    job();
+  });
+
+  /* The job refers to this frame, so it has to finish even if this context
+     gets interrupted meanwhile. The interrupt is passed on afterwards */
+  bool interrupted = false;
+  while (!done.get()) {
+    try {
+      done.wait();
+    } catch (System::InterruptedException&) {
+      interrupted = true;
+    }
+  }
+
+  if (interrupted) {
+    m_dispatcher.interrupt();
+  }
+
+  result.get();
+}
+
 bool RpcServer::on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, COMMAND_RPC_GET_BLOCKS_FAST::response& res) {
   // TODO code duplication see InProcessNode::doGetNewBlocks()
   if (req.block_ids.empty()) {
@@ -273,6 +377,38 @@ bool RpcServer::on_query_blocks_lite(const COMMAND_RPC_QUERY_BLOCKS_LITE::reques
   return true;
 }
 
+bool RpcServer::on_query_block_filters(const COMMAND_RPC_QUERY_BLOCK_FILTERS::request& req, COMMAND_RPC_QUERY_BLOCK_FILTERS::response& res) {
+  uint32_t startIndex;
+  uint32_t currentIndex;
+  uint32_t fullOffset;
+  if (!m_core.queryBlockFilters(req.blockIds, req.timestamp, startIndex, currentIndex, fullOffset, res.items)) {
+    res.status = "Failed to perform query";
+    return false;
+  }
+
+  res.startHeight = startIndex;
+  res.currentHeight = currentIndex;
+  res.fullOffset = fullOffset;
+  res.status = CORE_RPC_STATUS_OK;
+
+  return true;
+}
+
+bool RpcServer::on_get_blocks_lite(const COMMAND_RPC_GET_BLOCKS_LITE::request& req, COMMAND_RPC_GET_BLOCKS_LITE::response& res) {
+  if (req.blockIds.size() > COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT) {
+    res.status = "Too many blocks requested, maximum " + std::to_string(COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT);
+    return false;
+  }
+
+  if (!m_core.getBlocksLite(req.blockIds, res.items)) {
+    res.status = "Failed to get blocks";
+    return false;
+  }
+
+  res.status = CORE_RPC_STATUS_OK;
+  return true;
+}
+
 bool RpcServer::on_get_indexes(const COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::request& req, COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::response& res) {
   std::vector<uint32_t> outputIndexes;
   if (!m_core.getTransactionGlobalIndexes(req.txid, outputIndexes)) {
@@ -9,10 +9,12 @@
 #include "HttpServer.h"
 
 #include <functional>
+#include <memory>
 #include <unordered_map>
 
 #include <Logging/LoggerRef.h>
 #include "Common/Math.h"
+#include "Common/ThreadPool.h"
 #include "CoreRpcServerCommandsDefinitions.h"
 #include "JsonRpc.h"
 
@@ -24,7 +26,10 @@ struct ICryptoNoteProtocolHandler;
 
 class RpcServer : public HttpServer {
 public:
-  RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, Core& c, NodeServer& p2p, ICryptoNoteProtocolHandler& protocol);
+  /* With worker threads, requests that only read the chain are served on them
+     instead of the dispatcher thread, which keeps serving p2p and the core */
+  RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, Core& c, NodeServer& p2p, ICryptoNoteProtocolHandler& protocol,
+            size_t workerThreadCount = 0);
 
   typedef std::function<bool(RpcServer*, const HttpRequest& request, HttpResponse& response)> HandlerFunction;
   bool enableCors(const std::vector<std::string>  domains);
@@ -41,6 +46,7 @@ private:
   struct RpcHandler {
     const Handler handler;
     const bool allowBusyCore;
+    const bool readOnly;
   };
 
   typedef void (RpcServer::*HandlerPtr)(const HttpRequest& request, HttpResponse& response);
@@ -49,11 +55,14 @@ private:
   virtual void processRequest(const HttpRequest& request, HttpResponse& response) override;
   bool processJsonRpcRequest(const HttpRequest& request, HttpResponse& response);
   bool isCoreReady();
+  void runReadOnly(const std::function<void()>& job);
 
   // json handlers
   bool on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, COMMAND_RPC_GET_BLOCKS_FAST::response& res);
   bool on_query_blocks(const COMMAND_RPC_QUERY_BLOCKS::request& req, COMMAND_RPC_QUERY_BLOCKS::response& res);
   bool on_query_blocks_lite(const COMMAND_RPC_QUERY_BLOCKS_LITE::request& req, COMMAND_RPC_QUERY_BLOCKS_LITE::response& res);
+  bool on_query_block_filters(const COMMAND_RPC_QUERY_BLOCK_FILTERS::request& req, COMMAND_RPC_QUERY_BLOCK_FILTERS::response& res);
+  bool on_get_blocks_lite(const COMMAND_RPC_GET_BLOCKS_LITE::request& req, COMMAND_RPC_GET_BLOCKS_LITE::response& res);
   bool on_get_indexes(const COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::request& req, COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES::response& res);
   bool on_get_random_outs(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request& req, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response& res);
   bool onGetPoolChanges(const COMMAND_RPC_GET_POOL_CHANGES::request& req, COMMAND_RPC_GET_POOL_CHANGES::response& rsp);
@@ -96,6 +105,7 @@ private:
   std::vector<std::string> m_cors_domains;
   std::string m_fee_address;
   uint32_t m_fee_amount;
+  std::unique_ptr<Common::ThreadPool> m_workerPool;
 };
 
 }
@@ -25,13 +25,15 @@ namespace CryptoNote {
 
     const std::string DEFAULT_RPC_IP = "127.0.0.1";
     const uint16_t DEFAULT_RPC_PORT = RPC_DEFAULT_PORT;
+    const uint32_t DEFAULT_RPC_THREADS = 0;
 
     const command_line::arg_descriptor<std::string> arg_rpc_bind_ip = { "rpc-bind-ip", "Interface for RPC service", DEFAULT_RPC_IP };
     const command_line::arg_descriptor<uint16_t> arg_rpc_bind_port = { "rpc-bind-port", "Port for RPC service", DEFAULT_RPC_PORT };
+    const command_line::arg_descriptor<uint32_t> arg_rpc_threads = { "rpc-threads", "Number of threads serving RPC requests that only read the blockchain, 0 serves them on the core thread", DEFAULT_RPC_THREADS };
   }
 
 
-  RpcServerConfig::RpcServerConfig() : bindIp(DEFAULT_RPC_IP), bindPort(DEFAULT_RPC_PORT) {
+  RpcServerConfig::RpcServerConfig() : bindIp(DEFAULT_RPC_IP), bindPort(DEFAULT_RPC_PORT), threads(DEFAULT_RPC_THREADS) {
   }
 
   std::string RpcServerConfig::getBindAddress() const {
@@ -41,11 +43,13 @@ namespace CryptoNote {
   void RpcServerConfig::initOptions(boost::program_options::options_description& desc) {
     command_line::add_arg(desc, arg_rpc_bind_ip);
     command_line::add_arg(desc, arg_rpc_bind_port);
+    command_line::add_arg(desc, arg_rpc_threads);
   }
 
   void RpcServerConfig::init(const boost::program_options::variables_map& vm)  {
     bindIp = command_line::get_arg(vm, arg_rpc_bind_ip);
     bindPort = command_line::get_arg(vm, arg_rpc_bind_port);
+    threads = command_line::get_arg(vm, arg_rpc_threads);
   }
 
 }
@@ -20,9 +20,11 @@
 #include <list>
 #include <vector>
 #include <Common/MemoryInputStream.h>
+#include <Common/StreamTools.h>
 #include <Common/StringOutputStream.h>
 #include "JsonInputStreamSerializer.h"
 #include "JsonOutputStreamSerializer.h"
+#include "StreamingJsonOutputSerializer.h"
 #include "KVBinaryInputStreamSerializer.h"
 #include "KVBinaryOutputStreamSerializer.h"
 #include <zedwallet/Types.h>
@@ -113,6 +115,28 @@ std::string storeToJson(const T& v) {
   return storeToJsonValue(v).toString();
 }
 
+// Writes the same JSON as storeToJson, without building the JsonValue tree for objects
+template <typename T>
+void storeToJson(const T& v, Common::IOutputStream& stream) {
+  StreamingJsonOutputSerializer s(stream);
+  serialize(const_cast<T&>(v), s);
+  s.end();
+}
+
+template <typename T>
+void storeToJson(const std::vector<T>& v, Common::IOutputStream& stream) {
+  Common::write(stream, storeToJsonValue(v).toString());
+}
+
+template <typename T>
+void storeToJson(const std::list<T>& v, Common::IOutputStream& stream) {
+  Common::write(stream, storeToJsonValue(v).toString());
+}
+
+inline void storeToJson(const std::string& v, Common::IOutputStream& stream) {
+  Common::write(stream, storeToJsonValue(v).toString());
+}
+
 template <typename T>
 bool loadFromJson(T& v, const std::string& buf) {
   try {
@@ -150,4 +174,13 @@ bool loadFromBinaryKeyValue(T& v, const std::string& buf) {
   }
 }
 
+/* For debug checks of the .bin requests: buf, the KV-binary form of v, reads back
+   to a value with the same JSON form as v. The reader keeps one value per member
+   name, so a serializer repeating names within an object fails here */
+template <typename T>
+bool isBinaryKeyValueRoundTrip(const T& v, const std::string& buf) {
+  T loaded = T();
+  return loadFromBinaryKeyValue(loaded, buf) && storeToJson(loaded) == storeToJson(v);
+}
+
 }
@@ -0,0 +1,211 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "StreamingJsonOutputSerializer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+#include "Common/StreamTools.h"
+#include "Common/StringTools.h"
+
+using namespace CryptoNote;
+
+StreamingJsonOutputSerializer::StreamingJsonOutputSerializer(Common::IOutputStream& stream) : stream(stream) {
+  chain.push_back({false, true});
+  objects.emplace_back();
+}
+
+StreamingJsonOutputSerializer::~StreamingJsonOutputSerializer() {
+}
+
+void StreamingJsonOutputSerializer::end() {
+  assert(chain.size() == 1);
+  endLevel('}');
+}
+
+ISerializer::SerializerType StreamingJsonOutputSerializer::type() const {
+  return ISerializer::OUTPUT;
+}
+
+bool StreamingJsonOutputSerializer::beginObject(Common::StringView name) {
+  beginLevel('{', false, name);
+  return true;
+}
+
+void StreamingJsonOutputSerializer::endObject() {
+  endLevel('}');
+}
+
+bool StreamingJsonOutputSerializer::beginArray(size_t& size, Common::StringView name) {
+  beginLevel('[', true, name);
+  return true;
+}
+
+void StreamingJsonOutputSerializer::endArray() {
+  endLevel(']');
+}
+
+// Integers are written the way JsonOutputStreamSerializer stores them, as signed 64 bit values
+bool StreamingJsonOutputSerializer::operator()(uint64_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool StreamingJsonOutputSerializer::operator()(uint16_t& value, Common::StringView name) {
+  uint64_t v = static_cast<uint64_t>(value);
+  return operator()(v, name);
+}
+
+bool StreamingJsonOutputSerializer::operator()(int16_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool StreamingJsonOutputSerializer::operator()(uint32_t& value, Common::StringView name) {
+  uint64_t v = static_cast<uint64_t>(value);
+  return operator()(v, name);
+}
+
+bool StreamingJsonOutputSerializer::operator()(int32_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool StreamingJsonOutputSerializer::operator()(uint8_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool StreamingJsonOutputSerializer::operator()(int64_t& value, Common::StringView name) {
+  beginValue(name);
+  write(std::to_string(value));
+  return true;
+}
+
+bool StreamingJsonOutputSerializer::operator()(double& value, Common::StringView name) {
+  // same formatting as JsonValue
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(11) << value;
+  std::string result = text.str();
+  while (result.size() > 1 && result[result.size() - 2] != '.' && result[result.size() - 1] == '0') {
+    result.resize(result.size() - 1);
+  }
+
+  beginValue(name);
+  write(result);
+  return true;
+}
+
+bool StreamingJsonOutputSerializer::operator()(std::string& value, Common::StringView name) {
+  beginValue(name);
+  write('"');
+  write(value);
+  write('"');
+  return true;
+}
+
+bool StreamingJsonOutputSerializer::operator()(bool& value, Common::StringView name) {
+  beginValue(name);
+  write(value ? "true" : "false");
+  return true;
+}
+
+bool StreamingJsonOutputSerializer::binary(void* value, size_t size, Common::StringView name) {
+  std::string hex = Common::toHex(value, size);
+  return (*this)(hex, name);
+}
+
+bool StreamingJsonOutputSerializer::binary(std::string& value, Common::StringView name) {
+  return binary(const_cast<char*>(value.data()), value.size(), name);
+}
+
+void StreamingJsonOutputSerializer::beginValue(Common::StringView name) {
+  assert(!chain.empty());
+  Level& level = chain.back();
+
+  if (level.isArray) {
+    if (!level.isEmpty) {
+      write(',');
+    }
+
+    level.isEmpty = false;
+  } else {
+    Object& object = objects.back();
+    object.members.push_back({std::string(name), object.text.size()});
+  }
+}
+
+void StreamingJsonOutputSerializer::beginLevel(char opening, bool isArray, Common::StringView name) {
+  beginValue(name);
+  chain.push_back({isArray, true});
+
+  if (isArray) {
+    write(opening);
+  } else {
+    objects.emplace_back();
+  }
+}
+
+void StreamingJsonOutputSerializer::endLevel(char closing) {
+  assert(!chain.empty());
+  bool isArray = chain.back().isArray;
+  chain.pop_back();
+
+  if (isArray) {
+    write(closing);
+    return;
+  }
+
+  Object object = std::move(objects.back());
+  objects.pop_back();
+
+  // Sorted by name as JsonValue keeps them, a repeated name keeps its first value
+  std::vector<size_t> order(object.members.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&object](size_t a, size_t b) {
+    return object.members[a].name < object.members[b].name;
+  });
+
+  write('{');
+  const std::string* previousName = nullptr;
+  for (size_t index : order) {
+    const Member& member = object.members[index];
+    if (previousName != nullptr && *previousName == member.name) {
+      continue;
+    }
+
+    size_t end = index + 1 < object.members.size() ? object.members[index + 1].begin : object.text.size();
+    if (previousName != nullptr) {
+      write(',');
+    }
+
+    write('"');
+    write(member.name);
+    write("\":");
+    write(object.text.data() + member.begin, end - member.begin);
+    previousName = &member.name;
+  }
+
+  write(closing);
+}
+
+void StreamingJsonOutputSerializer::write(const std::string& text) {
+  write(text.data(), text.size());
+}
+
+void StreamingJsonOutputSerializer::write(char c) {
+  write(&c, 1);
+}
+
+void StreamingJsonOutputSerializer::write(const char* data, size_t size) {
+  if (objects.empty()) {
+    Common::write(stream, data, size);
+  } else {
+    objects.back().text.append(data, size);
+  }
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <Common/IOutputStream.h>
+#include "ISerializer.h"
+
+namespace CryptoNote {
+
+/* Writes the same JSON as JsonOutputStreamSerializer, as text while values
+   are serialized, without building a JsonValue tree first. Each object keeps
+   its members' text until it is closed, so they come out sorted by name like
+   before. The root object reaches the stream when end() closes it */
+class StreamingJsonOutputSerializer : public ISerializer {
+public:
+  /* Opens the root object, end() closes it and writes it out */
+  explicit StreamingJsonOutputSerializer(Common::IOutputStream& stream);
+  virtual ~StreamingJsonOutputSerializer();
+
+  void end();
+
+  SerializerType type() const override;
+
+  virtual bool beginObject(Common::StringView name) override;
+  virtual void endObject() override;
+
+  virtual bool beginArray(size_t& size, Common::StringView name) override;
+  virtual void endArray() override;
+
+  virtual bool operator()(uint8_t& value, Common::StringView name) override;
+  virtual bool operator()(int16_t& value, Common::StringView name) override;
+  virtual bool operator()(uint16_t& value, Common::StringView name) override;
+  virtual bool operator()(int32_t& value, Common::StringView name) override;
+  virtual bool operator()(uint32_t& value, Common::StringView name) override;
+  virtual bool operator()(int64_t& value, Common::StringView name) override;
+  virtual bool operator()(uint64_t& value, Common::StringView name) override;
+  virtual bool operator()(double& value, Common::StringView name) override;
+  virtual bool operator()(bool& value, Common::StringView name) override;
+  virtual bool operator()(std::string& value, Common::StringView name) override;
+  virtual bool binary(void* value, size_t size, Common::StringView name) override;
+  virtual bool binary(std::string& value, Common::StringView name) override;
+
+  template<typename T>
+  bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+
+private:
+  struct Level {
+    bool isArray;
+    bool isEmpty;
+  };
+
+  struct Member {
+    std::string name;
+    size_t begin;
+  };
+
+  // Text of an open object, its members' values are stored one after another
+  struct Object {
+    std::string text;
+    std::vector<Member> members;
+  };
+
+  void beginValue(Common::StringView name);
+  void beginLevel(char opening, bool isArray, Common::StringView name);
+  void endLevel(char closing);
+  void write(const std::string& text);
+  void write(char c);
+  void write(const char* data, size_t size);
+
+  Common::IOutputStream& stream;
+  std::vector<Level> chain;
+  std::vector<Object> objects;
+};
+
+}
@@ -459,20 +459,12 @@ void BlockchainSynchronizer::startBlockchainSync() {
 
   try {
     if (!req.knownBlocks.empty()) {
-      auto queryBlocksCompleted = std::promise<std::error_code>();
-      auto queryBlocksWaitFuture = queryBlocksCompleted.get_future();
-
-      m_node.queryBlocks(
-        std::move(req.knownBlocks),
-        req.syncStart.timestamp,
-        response.newBlocks,
-        response.startHeight,
-        [&queryBlocksCompleted](std::error_code ec) {
-          auto detachedPromise = std::move(queryBlocksCompleted);
-          detachedPromise.set_value(ec);
-        });
-
-      std::error_code ec = queryBlocksWaitFuture.get();
+      std::error_code ec = queryBlocksByFiltersSync(req, response);
+      if (ec) {
+        m_logger(DEBUGGING) << "Failed to query blocks by filters: " << ec << ", " << ec.message() << ", querying all blocks";
+        response.newBlocks.clear();
+        ec = queryBlocksSync(std::move(req), response);
+      }
 
       if (ec) {
         m_logger(ERROR, BRIGHT_RED) << "Failed to query blocks: " << ec << ", " << ec.message();
@@ -490,6 +482,110 @@ void BlockchainSynchronizer::startBlockchainSync() {
   }
 }
 
+std::error_code BlockchainSynchronizer::queryBlocksSync(GetBlocksRequest&& request, GetBlocksResponse& response) {
+  auto promise = std::promise<std::error_code>();
+  auto future = promise.get_future();
+
+  m_node.queryBlocks(
+    std::move(request.knownBlocks),
+    request.syncStart.timestamp,
+    response.newBlocks,
+    response.startHeight,
+    [&promise](std::error_code ec) {
+      auto detachedPromise = std::move(promise);
+      detachedPromise.set_value(ec);
+    });
+
+  return future.get();
+}
+
+/* Consumers check the block filters against their keys, then only the blocks
+   that may hold their transfers are downloaded. The others are passed on by
+   hash alone, like the blocks before the sync start */
+std::error_code BlockchainSynchronizer::queryBlocksByFiltersSync(const GetBlocksRequest& request, GetBlocksResponse& response) {
+  std::vector<BlockFilter> filters;
+  uint32_t startHeight = 0;
+
+  auto filtersPromise = std::promise<std::error_code>();
+  auto filtersFuture = filtersPromise.get_future();
+
+  m_node.queryBlockFilters(
+    std::vector<Crypto::Hash>(request.knownBlocks),
+    request.syncStart.timestamp,
+    filters,
+    startHeight,
+    [&filtersPromise](std::error_code ec) {
+      auto detachedPromise = std::move(filtersPromise);
+      detachedPromise.set_value(ec);
+    });
+
+  std::error_code ec = filtersFuture.get();
+  if (ec) {
+    return ec;
+  }
+
+  std::vector<bool> relevant(filters.size(), false);
+  {
+    std::unique_lock<std::mutex> lk(m_consumersMutex);
+    for (auto& consumer : m_consumers) {
+      consumer.first->markRelevantBlocks(filters, relevant);
+    }
+  }
+
+  std::vector<Crypto::Hash> relevantHashes;
+  for (size_t i = 0; i < filters.size(); ++i) {
+    if (relevant[i]) {
+      relevantHashes.push_back(filters[i].blockHash);
+    }
+  }
+
+  m_logger(DEBUGGING) << "Block filters received, start index " << startHeight << ", count " << filters.size() <<
+    ", matched " << relevantHashes.size();
+
+  std::vector<BlockShortEntry> relevantBlocks;
+  if (!relevantHashes.empty()) {
+    auto blocksPromise = std::promise<std::error_code>();
+    auto blocksFuture = blocksPromise.get_future();
+
+    m_node.getBlocksLite(
+      std::move(relevantHashes),
+      relevantBlocks,
+      [&blocksPromise](std::error_code ec) {
+        auto detachedPromise = std::move(blocksPromise);
+        detachedPromise.set_value(ec);
+      });
+
+    ec = blocksFuture.get();
+    if (ec) {
+      return ec;
+    }
+  }
+
+  response.startHeight = startHeight;
+  response.newBlocks.reserve(filters.size());
+
+  auto relevantBlock = relevantBlocks.begin();
+  for (size_t i = 0; i < filters.size(); ++i) {
+    if (!relevant[i]) {
+      BlockShortEntry entry;
+      entry.blockHash = filters[i].blockHash;
+      entry.hasBlock = false;
+      response.newBlocks.push_back(std::move(entry));
+      continue;
+    }
+
+    if (relevantBlock == relevantBlocks.end() || relevantBlock->blockHash != filters[i].blockHash || !relevantBlock->hasBlock) {
+      m_logger(ERROR, BRIGHT_RED) << "Node returned other blocks than requested, block index " << (startHeight + i);
+      return std::make_error_code(std::errc::invalid_argument);
+    }
+
+    response.newBlocks.push_back(std::move(*relevantBlock));
+    ++relevantBlock;
+  }
+
+  return std::error_code();
+}
+
 void BlockchainSynchronizer::processBlocks(GetBlocksResponse& response) {
   m_logger(DEBUGGING) << "Process blocks, start index " << response.startHeight << ", count " << response.newBlocks.size();
 
@@ -107,6 +107,8 @@ private:
   void startPoolSync();
   void startBlockchainSync();
 
+  std::error_code queryBlocksSync(GetBlocksRequest&& request, GetBlocksResponse& response);
+  std::error_code queryBlocksByFiltersSync(const GetBlocksRequest& request, GetBlocksResponse& response);
   void processBlocks(GetBlocksResponse& response);
   UpdateConsumersResult updateConsumers(const BlockchainInterval& interval, const std::vector<CompleteBlock>& blocks);
   std::error_code processPoolTxs(GetPoolResponse& response);
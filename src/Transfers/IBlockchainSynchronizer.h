@@ -23,6 +23,7 @@
 #include <unordered_set>
 
 #include "crypto/crypto.h"
+#include "CryptoNoteCore/BlockFilter.h"
 #include "CryptoNoteCore/CryptoNoteBasic.h"
 
 #include "IObservable.h"
@@ -48,6 +49,8 @@ public:
   virtual const std::unordered_set<Crypto::Hash>& getKnownPoolTxIds() const = 0;
   virtual void onBlockchainDetach(uint32_t height) = 0;
   virtual uint32_t onNewBlocks(const CompleteBlock* blocks, uint32_t startHeight, uint32_t count) = 0;
+  // sets relevant[i] if the block of filters[i] may hold transfers of this consumer, leaves it as is otherwise
+  virtual void markRelevantBlocks(const std::vector<BlockFilter>& filters, std::vector<bool>& relevant) = 0;
   virtual std::error_code onPoolUpdated(const std::vector<std::unique_ptr<ITransactionReader>>& addedTransactions, const std::vector<Crypto::Hash>& deletedTransactions) = 0;
 
   virtual std::error_code addUnconfirmedTransaction(const ITransactionReader& transaction) = 0;
@@ -7,11 +7,13 @@
 
 #include "TransfersConsumer.h"
 
+#include <atomic>
 #include <numeric>
 #include <future>
 
 #include "CommonTypes.h"
-#include "Common/BlockingQueue.h"
+#include "Common/ThreadPool.h"
+#include "CryptoNoteCore/BlockFilter.h"
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 #include "CryptoNoteCore/TransactionApi.h"
@@ -63,19 +65,21 @@ void checkOutputKey(
 
 }
 
+// Transactions go to the scanning threads in chunks, the key derivations of a chunk are generated together
+const size_t SCANNING_CHUNK_SIZE = 32;
+
+// Shared by all consumers, so wallets catching up together don't each start their own threads
+Common::ThreadPool& getScanningThreadPool() {
+  static Common::ThreadPool threadPool;
+  return threadPool;
+}
+
 void findMyOutputs(
   const ITransactionReader& tx,
-  const SecretKey& viewSecretKey,
+  const KeyDerivation& derivation,
   const std::unordered_set<PublicKey>& spendKeys,
   std::unordered_map<PublicKey, std::vector<uint32_t>>& outputs) {
 
-  auto txPublicKey = tx.getTransactionPublicKey();
-  KeyDerivation derivation;
-
-  if (!generate_key_derivation( txPublicKey, viewSecretKey, derivation)) {
-    return;
-  }
-
   size_t keyIndex = 0;
   size_t outputCount = tx.getOutputCount();
 
@@ -208,82 +212,93 @@ uint32_t TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t st
 
   struct PreprocessedTx : Tx, PreprocessInfo {};
 
+  /* Transactions are laid out in block and position order up front. Each scanning thread fills in the
+     slots of the chunks it takes, so the results need neither a lock nor sorting afterwards */
   std::vector<PreprocessedTx> preprocessedTransactions;
-  std::mutex preprocessedTransactionsMutex;
 
-  size_t workers = std::thread::hardware_concurrency();
-  if (workers == 0) {
-    workers = 2;
-  }
+  for (uint32_t i = 0; i < count; ++i) {
+    const auto& block = blocks[i].block;
 
-  BlockingQueue<Tx> inputQueue(workers * 2);
-
-  std::atomic<bool> stopProcessing(false);
-  std::atomic<size_t> emptyBlockCount(0);
+    if (!block.is_initialized()) {
+      continue;
+    }
 
-  auto pushingThread = std::async(std::launch::async, [&] {
-    for( uint32_t i = 0; i < count && !stopProcessing; ++i) {
-      const auto& block = blocks[i].block;
+    // filter by syncStartTimestamp
+    if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp) {
+      continue;
+    }
 
-      if (!block.is_initialized()) {
-        ++emptyBlockCount;
-        continue;
-      }
+    TransactionBlockInfo blockInfo;
+    blockInfo.height = startHeight + i;
+    blockInfo.timestamp = block->timestamp;
+    blockInfo.transactionIndex = 0; // position in block
 
-      // filter by syncStartTimestamp
-      if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp) {
-        ++emptyBlockCount;
+    for (const auto& tx : blocks[i].transactions) {
+      auto pubKey = tx->getTransactionPublicKey();
+      if (pubKey == NULL_PUBLIC_KEY) {
+        ++blockInfo.transactionIndex;
         continue;
       }
 
-      TransactionBlockInfo blockInfo;
-      blockInfo.height = startHeight + i;
-      blockInfo.timestamp = block->timestamp;
-      blockInfo.transactionIndex = 0; // position in block
-
-      for (const auto& tx : blocks[i].transactions) {
-        auto pubKey = tx->getTransactionPublicKey();
-        if (pubKey == NULL_PUBLIC_KEY) {
-          ++blockInfo.transactionIndex;
-          continue;
-        }
-
-        bool isLastTransactionInBlock = blockInfo.transactionIndex + 1 == blocks[i].transactions.size();
-        Tx item = { blockInfo, tx.get(), isLastTransactionInBlock };
-        inputQueue.push(item);
-        ++blockInfo.transactionIndex;
-      }
+      PreprocessedTx item;
+      item.blockInfo = blockInfo;
+      item.tx = tx.get();
+      item.isLastTransactionInBlock = blockInfo.transactionIndex + 1 == blocks[i].transactions.size();
+      preprocessedTransactions.push_back(std::move(item));
+      ++blockInfo.transactionIndex;
     }
+  }
 
-    inputQueue.close();
-  });
+  std::atomic<bool> stopProcessing(false);
+  std::atomic<size_t> nextChunk(0);
 
   auto processingFunction = [&] {
-    Tx item;
     std::error_code ec;
-    while (!stopProcessing && inputQueue.pop(item)) {
-      PreprocessedTx output;
-      static_cast<Tx&>(output) = item;
+    PublicKey transactionKeys[SCANNING_CHUNK_SIZE];
+    KeyDerivation derivations[SCANNING_CHUNK_SIZE];
+    bool derived[SCANNING_CHUNK_SIZE];
 
-      ec = preprocessOutputs(item.blockInfo, *item.tx, output);
-      if (ec) {
-        stopProcessing = true;
+    while (!stopProcessing) {
+      size_t chunkBegin = nextChunk.fetch_add(SCANNING_CHUNK_SIZE);
+      if (chunkBegin >= preprocessedTransactions.size()) {
         break;
       }
 
-      std::lock_guard<std::mutex> lk(preprocessedTransactionsMutex);
-      preprocessedTransactions.push_back(std::move(output));
+      size_t chunkEnd = std::min(chunkBegin + SCANNING_CHUNK_SIZE, preprocessedTransactions.size());
+      for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+        transactionKeys[i - chunkBegin] = preprocessedTransactions[i].tx->getTransactionPublicKey();
+      }
+
+      generate_key_derivations(transactionKeys, chunkEnd - chunkBegin, m_viewSecret, derivations, derived);
+
+      for (size_t i = chunkBegin; i < chunkEnd && !stopProcessing; ++i) {
+        if (!derived[i - chunkBegin]) {
+          continue;
+        }
+
+        auto& item = preprocessedTransactions[i];
+        ec = preprocessOutputs(item.blockInfo, *item.tx, derivations[i - chunkBegin], item);
+        if (ec) {
+          stopProcessing = true;
+          break;
+        }
+      }
     }
+
     return ec;
   };
 
-  std::vector<std::future<std::error_code>> processingThreads;
-  for (size_t i = 0; i < workers; ++i) {
-    processingThreads.push_back(std::async(std::launch::async, processingFunction));
+  auto& threadPool = getScanningThreadPool();
+  size_t jobCount = std::min(threadPool.getThreadCount(),
+                             (preprocessedTransactions.size() + SCANNING_CHUNK_SIZE - 1) / SCANNING_CHUNK_SIZE);
+
+  std::vector<std::future<std::error_code>> processingJobs;
+  for (size_t i = 0; i < jobCount; ++i) {
+    processingJobs.push_back(threadPool.addJob(processingFunction));
   }
 
   std::error_code processingError;
-  for (auto& f : processingThreads) {
+  for (auto& f : processingJobs) {
     try {
       std::error_code ec = f.get();
       if (!processingError && ec) {
@@ -307,27 +322,32 @@ uint32_t TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t st
   std::vector<Crypto::Hash> blockHashes = getBlockHashes(blocks, count);
   m_observerManager.notify(&IBlockchainConsumerObserver::onBlocksAdded, this, blockHashes);
 
-  // sort by block height and transaction index in block
-  std::sort(preprocessedTransactions.begin(), preprocessedTransactions.end(), [](const PreprocessedTx& a, const PreprocessedTx& b) {
-    return std::tie(a.blockInfo.height, a.blockInfo.transactionIndex) < std::tie(b.blockInfo.height, b.blockInfo.transactionIndex);
-  });
-
-  uint32_t processedBlockCount = static_cast<uint32_t>(emptyBlockCount);
+  uint32_t processedBlockCount = 0;
   try {
     for (const auto& tx : preprocessedTransactions) {
+      // Blocks before this one are done, including the skipped ones that carry no transactions
+      processedBlockCount = tx.blockInfo.height - startHeight;
+
       processTransaction(tx.blockInfo, *tx.tx, tx);
 
       if (tx.isLastTransactionInBlock) {
-        ++processedBlockCount;
+        processedBlockCount = tx.blockInfo.height - startHeight + 1;
         m_logger(TRACE) << "Processed block " << processedBlockCount << " of " << count << ", last processed block index " << tx.blockInfo.height <<
             ", hash " << blocks[processedBlockCount - 1].blockHash;
 
-        auto newHeight = startHeight + processedBlockCount - 1;
+        auto newHeight = tx.blockInfo.height;
         forEachSubscription([newHeight](TransfersSubscription& sub) {
             sub.advanceHeight(newHeight);
         });
       }
     }
+
+    // Blocks skipped by their filters come without transactions, the height still has to move past them
+    processedBlockCount = count;
+    auto newHeight = startHeight + count - 1;
+    forEachSubscription([newHeight](TransfersSubscription& sub) {
+        sub.advanceHeight(newHeight);
+    });
   } catch (const MarkTransactionConfirmedException& e) {
     m_logger(ERROR, BRIGHT_RED) << "Failed to process block transactions: failed to confirm transaction " << e.getTxHash() <<
       ", remove this transaction from all containers and transaction pool";
@@ -355,6 +375,110 @@ uint32_t TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t st
   return processedBlockCount;
 }
 
+void TransfersConsumer::markRelevantBlocks(const std::vector<BlockFilter>& filters, std::vector<bool>& relevant) {
+  assert(filters.size() == relevant.size());
+
+  struct FilterMatch {
+    std::unique_ptr<BlockFilterMatcher> matcher;
+    bool hasOutputs = false;
+    // key images of the matched outputs, to find them being spent in later blocks
+    std::vector<KeyImage> keyImages;
+  };
+
+  std::vector<FilterMatch> matches(filters.size());
+  std::atomic<size_t> nextFilter(0);
+
+  /* The output keys this wallet would own in each block are derived on the scanning threads, the same
+     work as scanning a block but without downloading it */
+  auto matchingFunction = [&] {
+    for (;;) {
+      size_t index = nextFilter.fetch_add(1);
+      if (index >= filters.size()) {
+        return;
+      }
+
+      const BlockFilter& filter = filters[index];
+      FilterMatch& match = matches[index];
+
+      try {
+        match.matcher.reset(new BlockFilterMatcher(filter));
+      } catch (const std::exception& e) {
+        m_logger(WARNING, BRIGHT_YELLOW) << "Malformed filter of block " << filter.blockHash << ": " << e.what();
+        match.hasOutputs = true;
+        continue;
+      }
+
+      size_t transactionCount = filter.transactionPublicKeys.size();
+      std::vector<KeyDerivation> derivations(transactionCount);
+      std::unique_ptr<bool[]> derived(new bool[transactionCount]);
+      generate_key_derivations(filter.transactionPublicKeys.data(), transactionCount, m_viewSecret, derivations.data(), derived.get());
+
+      for (size_t i = 0; i < transactionCount; ++i) {
+        if (!derived[i]) {
+          continue;
+        }
+
+        for (uint32_t outputIndex = 0; outputIndex < filter.outputCounts[i]; ++outputIndex) {
+          for (const auto& kv : m_subscriptions) {
+            const AccountKeys& keys = kv.second->getKeys();
+
+            PublicKey outputKey;
+            if (!derive_public_key(derivations[i], outputIndex, keys.address.spendPublicKey, outputKey) ||
+                !match.matcher->mayContain(outputKey)) {
+              continue;
+            }
+
+            match.hasOutputs = true;
+            if (keys.spendSecretKey != NULL_SECRET_KEY) {
+              SecretKey outputSecretKey;
+              KeyImage keyImage;
+              derive_secret_key(derivations[i], outputIndex, keys.spendSecretKey, outputSecretKey);
+              generate_key_image(outputKey, outputSecretKey, keyImage);
+              match.keyImages.push_back(keyImage);
+            }
+          }
+        }
+      }
+    }
+  };
+
+  auto& threadPool = getScanningThreadPool();
+  size_t jobCount = std::min(threadPool.getThreadCount(), filters.size());
+
+  std::vector<std::future<void>> matchingJobs;
+  for (size_t i = 0; i < jobCount; ++i) {
+    matchingJobs.push_back(threadPool.addJob(matchingFunction));
+  }
+
+  for (auto& job : matchingJobs) {
+    job.get();
+  }
+
+  // Spends are found in block order, an output matched in one block may be spent in a later one
+  std::unordered_set<KeyImage> keyImages;
+  forEachSubscription([&keyImages](TransfersSubscription& sub) {
+    if (sub.getKeys().spendSecretKey == NULL_SECRET_KEY) {
+      return;
+    }
+
+    sub.getUnspentKeyImages(keyImages);
+  });
+
+  for (size_t i = 0; i < filters.size(); ++i) {
+    const FilterMatch& match = matches[i];
+
+    if (match.hasOutputs) {
+      relevant[i] = true;
+    } else if (!relevant[i]) {
+      relevant[i] = std::any_of(keyImages.begin(), keyImages.end(), [&match](const KeyImage& keyImage) {
+        return match.matcher->mayContain(keyImage);
+      });
+    }
+
+    keyImages.insert(match.keyImages.begin(), match.keyImages.end());
+  }
+}
+
 std::error_code TransfersConsumer::onPoolUpdated(const std::vector<std::unique_ptr<ITransactionReader>>& addedTransactions, const std::vector<Hash>& deletedTransactions) {
   TransactionBlockInfo unconfirmedBlockInfo;
   unconfirmedBlockInfo.timestamp = 0;
@@ -497,10 +621,20 @@ std::error_code createTransfers(
 }
 
 std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx, PreprocessInfo& info) {
+  KeyDerivation derivation;
+  if (!generate_key_derivation(tx.getTransactionPublicKey(), m_viewSecret, derivation)) {
+    return std::error_code();
+  }
+
+  return preprocessOutputs(blockInfo, tx, derivation, info);
+}
+
+std::error_code TransfersConsumer::preprocessOutputs(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx,
+                                                     const KeyDerivation& derivation, PreprocessInfo& info) {
   std::unordered_map<PublicKey, std::vector<uint32_t>> outputs;
   try
   {
-    findMyOutputs(tx, m_viewSecret, m_spendKeys, outputs);
+    findMyOutputs(tx, derivation, m_spendKeys, outputs);
   }
   catch (const std::exception& e)
   {
@@ -151,6 +151,9 @@ size_t SpentOutputDescriptor::hash() const {
 
 TransfersContainer::TransfersContainer(const Currency& currency, Logging::ILogger& logger, size_t transactionSpendableAge) :
   m_currentHeight(0),
+  m_lockedBalance(0),
+  m_softLockedBalance(0),
+  m_unlockedBalance(0),
   m_currency(currency),
   m_logger(logger, "TransfersContainer"),
   m_transactionSpendableAge(transactionSpendableAge) {
@@ -182,7 +185,7 @@ bool TransfersContainer::addTransaction(const TransactionBlockInfo& block, const
     }
 
     if (block.height != WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
-      m_currentHeight = block.height;
+      setCurrentHeight(block.height);
     }
 
     return added;
@@ -597,7 +600,7 @@ std::vector<Hash> TransfersContainer::detach(uint32_t height) {
   }
 
   // TODO: notification on detach
-  m_currentHeight = height == 0 ? 0 : height - 1;
+  setCurrentHeight(height == 0 ? 0 : height - 1);
 
   return deletedTransactions;
 }
@@ -649,19 +652,219 @@ void TransfersContainer::updateTransfersVisibility(const KeyImage& keyImage) {
   } else {
     updateVisibility(unconfirmedIndex, unconfirmedRange, unconfirmedCount == 1);
   }
+
+  updateBalance(keyImage);
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::updateBalance(const KeyImage& keyImage) {
+  removeFromBalance(keyImage);
+
+  SpentOutputDescriptor descriptor(&keyImage);
+  auto availableRange = m_availableTransfers.get<SpentOutputDescriptorIndex>().equal_range(descriptor);
+  auto unconfirmedRange = m_unconfirmedTransfers.get<SpentOutputDescriptorIndex>().equal_range(descriptor);
+
+  auto visibleIt = std::find_if(availableRange.first, availableRange.second, [](const TransactionOutputInformationEx& t) { return t.visible; });
+  if (visibleIt != availableRange.second) {
+    addToBalance(keyImage, { visibleIt->amount, visibleIt->blockHeight, visibleIt->unlockTime });
+    return;
+  }
+
+  visibleIt = std::find_if(unconfirmedRange.first, unconfirmedRange.second, [](const TransactionOutputInformationEx& t) { return t.visible; });
+  if (visibleIt != unconfirmedRange.second) {
+    addToBalance(keyImage, { visibleIt->amount, visibleIt->blockHeight, visibleIt->unlockTime });
+  }
+}
+
+namespace {
+  void subtractFromBucket(std::map<uint32_t, uint64_t>& buckets, uint32_t height, uint64_t amount) {
+    auto it = buckets.find(height);
+    assert(it != buckets.end() && it->second >= amount);
+    it->second -= amount;
+    if (it->second == 0) {
+      buckets.erase(it);
+    }
+  }
+
+  // Sum of the buckets at heights above from and up to to
+  uint64_t sumBuckets(const std::map<uint32_t, uint64_t>& buckets, uint32_t from, uint32_t to) {
+    uint64_t sum = 0;
+    for (auto it = buckets.upper_bound(from); it != buckets.end() && it->first <= to; ++it) {
+      sum += it->second;
+    }
+
+    return sum;
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::addToBalance(const KeyImage& keyImage, const BalanceTransfer& transfer) {
+  auto result = m_balanceTransfers.emplace(keyImage, transfer);
+  (void)result; // Disable unused warning
+  assert(result.second);
+
+  if (isTimeLocked(transfer)) {
+    m_timeLockedTransfers.insert(keyImage);
+    return;
+  }
+
+  getStateBalance(getBalanceState(transfer)) += transfer.amount;
+
+  if (transfer.blockHeight != WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
+    m_lockedBalanceEnds[getLockedUntil(transfer)] += transfer.amount;
+    m_softLockedBalanceEnds[getSoftLockedUntil(transfer)] += transfer.amount;
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::removeFromBalance(const KeyImage& keyImage) {
+  auto it = m_balanceTransfers.find(keyImage);
+  if (it == m_balanceTransfers.end()) {
+    return;
+  }
+
+  const BalanceTransfer& transfer = it->second;
+  if (isTimeLocked(transfer)) {
+    m_timeLockedTransfers.erase(keyImage);
+  } else {
+    getStateBalance(getBalanceState(transfer)) -= transfer.amount;
+
+    if (transfer.blockHeight != WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
+      subtractFromBucket(m_lockedBalanceEnds, getLockedUntil(transfer), transfer.amount);
+      subtractFromBucket(m_softLockedBalanceEnds, getSoftLockedUntil(transfer), transfer.amount);
+    }
+  }
+
+  m_balanceTransfers.erase(it);
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::rebuildBalance() {
+  m_balanceTransfers.clear();
+  m_timeLockedTransfers.clear();
+  m_lockedBalanceEnds.clear();
+  m_softLockedBalanceEnds.clear();
+  m_lockedBalance = 0;
+  m_softLockedBalance = 0;
+  m_unlockedBalance = 0;
+
+  for (const auto& t : m_availableTransfers) {
+    if (t.visible && t.type == TransactionTypes::OutputType::Key) {
+      addToBalance(t.keyImage, { t.amount, t.blockHeight, t.unlockTime });
+    }
+  }
+
+  for (const auto& t : m_unconfirmedTransfers) {
+    if (t.visible && t.type == TransactionTypes::OutputType::Key) {
+      addToBalance(t.keyImage, { t.amount, t.blockHeight, t.unlockTime });
+    }
+  }
+}
+
+/**
+ * \pre m_mutex is locked.
+ */
+void TransfersContainer::setCurrentHeight(uint32_t height) {
+  if (height > m_currentHeight) {
+    uint64_t lockEnded = sumBuckets(m_lockedBalanceEnds, m_currentHeight, height);
+    uint64_t softLockEnded = sumBuckets(m_softLockedBalanceEnds, m_currentHeight, height);
+
+    m_lockedBalance -= lockEnded;
+    m_softLockedBalance += lockEnded;
+    m_softLockedBalance -= softLockEnded;
+    m_unlockedBalance += softLockEnded;
+  } else if (height < m_currentHeight) {
+    uint64_t lockStarted = sumBuckets(m_lockedBalanceEnds, height, m_currentHeight);
+    uint64_t softLockStarted = sumBuckets(m_softLockedBalanceEnds, height, m_currentHeight);
+
+    m_unlockedBalance -= softLockStarted;
+    m_softLockedBalance += softLockStarted;
+    m_softLockedBalance -= lockStarted;
+    m_lockedBalance += lockStarted;
+  }
+
+  m_currentHeight = height;
+}
+
+bool TransfersContainer::isTimeLocked(const BalanceTransfer& transfer) const {
+  return transfer.unlockTime >= m_currency.maxBlockHeight();
+}
+
+// First height at which the output is no longer locked by its unlock time
+uint32_t TransfersContainer::getLockedUntil(const BalanceTransfer& transfer) const {
+  assert(!isTimeLocked(transfer));
+  uint64_t deltaBlocks = m_currency.lockedTxAllowedDeltaBlocks();
+  return transfer.unlockTime > deltaBlocks ? static_cast<uint32_t>(transfer.unlockTime - deltaBlocks) : 0;
+}
+
+// First height at which the output is unlocked
+uint32_t TransfersContainer::getSoftLockedUntil(const BalanceTransfer& transfer) const {
+  return std::max(getLockedUntil(transfer), static_cast<uint32_t>(transfer.blockHeight + m_transactionSpendableAge));
+}
+
+uint32_t TransfersContainer::getBalanceState(const BalanceTransfer& transfer) const {
+  if (transfer.blockHeight == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT || !isSpendTimeUnlocked(transfer.unlockTime)) {
+    return IncludeStateLocked;
+  } else if (m_currentHeight < transfer.blockHeight + m_transactionSpendableAge) {
+    return IncludeStateSoftLocked;
+  } else {
+    return IncludeStateUnlocked;
+  }
+}
+
+uint64_t& TransfersContainer::getStateBalance(uint32_t state) {
+  switch (state) {
+  case IncludeStateLocked:
+    return m_lockedBalance;
+  case IncludeStateSoftLocked:
+    return m_softLockedBalance;
+  default:
+    assert(state == IncludeStateUnlocked);
+    return m_unlockedBalance;
+  }
 }
 
 bool TransfersContainer::advanceHeight(uint32_t height) {
   std::lock_guard<std::mutex> lk(m_mutex);
 
   if (m_currentHeight <= height) {
-    m_currentHeight = height;
+    setCurrentHeight(height);
     return true;
   }
 
   return false;
 }
 
+void TransfersContainer::getUnspentKeyImages(std::unordered_set<Crypto::KeyImage>& keyImages) const {
+  std::lock_guard<std::mutex> lk(m_mutex);
+  for (const auto& t : m_availableTransfers) {
+    if (t.type == TransactionTypes::OutputType::Key) {
+      keyImages.insert(t.keyImage);
+    }
+  }
+
+  for (const auto& t : m_unconfirmedTransfers) {
+    if (t.type == TransactionTypes::OutputType::Key) {
+      keyImages.insert(t.keyImage);
+    }
+  }
+
+  // Outputs spent by a pool transaction still have to be seen spent in a block for it to confirm
+  for (const auto& t : m_spentTransfers) {
+    if (t.type == TransactionTypes::OutputType::Key && t.spendingBlock.height == WALLET_LEGACY_UNCONFIRMED_TRANSACTION_HEIGHT) {
+      keyImages.insert(t.keyImage);
+    }
+  }
+}
+
 size_t TransfersContainer::transfersCount() const {
   std::lock_guard<std::mutex> lk(m_mutex);
   return m_unconfirmedTransfers.size() + m_availableTransfers.size() + m_spentTransfers.size();
@@ -674,19 +877,26 @@ size_t TransfersContainer::transactionsCount() const {
 
 uint64_t TransfersContainer::balance(uint32_t flags) const {
   std::lock_guard<std::mutex> lk(m_mutex);
+
+  // The totals hold key outputs only, each is filtered by type and state as its transfers would be
+  const auto type = TransactionTypes::OutputType::Key;
   uint64_t amount = 0;
+  if (isIncluded(type, IncludeStateLocked, flags)) {
+    amount += m_lockedBalance;
+  }
 
-  for (const auto& t : m_availableTransfers) {
-    if (t.visible && isIncluded(t, flags)) {
-      amount += t.amount;
-    }
+  if (isIncluded(type, IncludeStateSoftLocked, flags)) {
+    amount += m_softLockedBalance;
   }
 
-  if ((flags & IncludeStateLocked) != 0) {
-    for (const auto& t : m_unconfirmedTransfers) {
-      if (t.visible && isIncluded(t.type, IncludeStateLocked, flags)) {
-        amount += t.amount;
-      }
+  if (isIncluded(type, IncludeStateUnlocked, flags)) {
+    amount += m_unlockedBalance;
+  }
+
+  for (const auto& keyImage : m_timeLockedTransfers) {
+    const BalanceTransfer& transfer = m_balanceTransfers.at(keyImage);
+    if (isIncluded(type, getBalanceState(transfer), flags)) {
+      amount += transfer.amount;
     }
   }
 
@@ -882,6 +1092,7 @@ void TransfersContainer::load(std::istream& in) {
   m_unconfirmedTransfers = std::move(unconfirmedTransfers);
   m_availableTransfers = std::move(availableTransfers);
   m_spentTransfers = std::move(spentTransfers);
+  rebuildBalance();
 
   // Repair the container if it was broken while handling addTransaction() in previous version of the code
   // Hope it isn't necessary anymore
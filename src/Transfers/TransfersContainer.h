@@ -18,7 +18,9 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 
 #include <boost/multi_index_container.hpp>
@@ -155,6 +157,8 @@ public:
 
   std::vector<Crypto::Hash> detach(uint32_t height);
   bool advanceHeight(uint32_t height);
+  // key images of the key outputs not yet spent in the blockchain, unconfirmed ones included
+  void getUnspentKeyImages(std::unordered_set<Crypto::KeyImage>& keyImages) const;
 
   // ITransfersContainer
   virtual size_t transfersCount() const override;
@@ -267,6 +271,27 @@ private:
   static bool isIncluded(TransactionTypes::OutputType type, uint32_t state, uint32_t flags);
   void updateTransfersVisibility(const Crypto::KeyImage& keyImage);
 
+  /* Key outputs counted in the balance, one per key image, which is the
+     visible one. Each is kept in the running total of the state it has at
+     the current height, and indexed by the heights where that state ends,
+     so a height change only visits the outputs that change state */
+  struct BalanceTransfer {
+    uint64_t amount;
+    uint32_t blockHeight;
+    uint64_t unlockTime;
+  };
+
+  void updateBalance(const Crypto::KeyImage& keyImage);
+  void addToBalance(const Crypto::KeyImage& keyImage, const BalanceTransfer& transfer);
+  void removeFromBalance(const Crypto::KeyImage& keyImage);
+  void rebuildBalance();
+  void setCurrentHeight(uint32_t height);
+  bool isTimeLocked(const BalanceTransfer& transfer) const;
+  uint32_t getLockedUntil(const BalanceTransfer& transfer) const;
+  uint32_t getSoftLockedUntil(const BalanceTransfer& transfer) const;
+  uint32_t getBalanceState(const BalanceTransfer& transfer) const;
+  uint64_t& getStateBalance(uint32_t state);
+
   void copyToSpent(const TransactionBlockInfo& block, const ITransactionReader& tx, size_t inputIndex, const TransactionOutputInformationEx& output);
   void repair();
 
@@ -277,6 +302,14 @@ private:
   SpentTransfersMultiIndex m_spentTransfers;
 
   uint32_t m_currentHeight; // current height is needed to check if a transfer is unlocked
+  std::unordered_map<Crypto::KeyImage, BalanceTransfer> m_balanceTransfers;
+  // outputs locked until a timestamp are checked on every query, they don't change state with the height
+  std::unordered_set<Crypto::KeyImage> m_timeLockedTransfers;
+  std::map<uint32_t, uint64_t> m_lockedBalanceEnds;
+  std::map<uint32_t, uint64_t> m_softLockedBalanceEnds;
+  uint64_t m_lockedBalance;
+  uint64_t m_softLockedBalance;
+  uint64_t m_unlockedBalance;
   size_t m_transactionSpendableAge;
   const CryptoNote::Currency& m_currency;
   mutable std::mutex m_mutex;
@@ -53,6 +53,10 @@ bool TransfersSubscription::advanceHeight(uint32_t height) {
   return transfers.advanceHeight(height);
 }
 
+void TransfersSubscription::getUnspentKeyImages(std::unordered_set<Crypto::KeyImage>& keyImages) const {
+  transfers.getUnspentKeyImages(keyImages);
+}
+
 const AccountKeys& TransfersSubscription::getKeys() const {
   return subscription.keys;
 }
@@ -33,6 +33,7 @@ public:
   void onBlockchainDetach(uint32_t height);
   void onError(const std::error_code& ec, uint32_t height);
   bool advanceHeight(uint32_t height);
+  void getUnspentKeyImages(std::unordered_set<Crypto::KeyImage>& keyImages) const;
   const AccountKeys& getKeys() const;
   bool addTransaction(const TransactionBlockInfo& blockInfo, const ITransactionReader& tx,
                       const std::vector<TransactionOutputInformationIn>& transfers);
@@ -0,0 +1,439 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "WalletCacheJournal.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+
+#include "Common/MemoryInputStream.h"
+#include "Common/VectorOutputStream.h"
+#include "CryptoNoteCore/CryptoNoteSerialization.h"
+#include "crypto/crypto.h"
+#include "Serialization/BinaryInputStreamSerializer.h"
+#include "Serialization/BinaryOutputStreamSerializer.h"
+#include "Serialization/SerializationOverloads.h"
+
+namespace CryptoNote {
+
+namespace {
+
+const uint64_t MIN_CHUNK_SIZE = 2 * 1024;
+const uint64_t MAX_CHUNK_SIZE = 64 * 1024;
+// A boundary needs the top 13 bits of the rolling hash clear, which makes chunks of about 8 KiB
+const uint64_t CHUNK_BOUNDARY_MASK = UINT64_C(0xFFF8000000000000);
+
+// Below this the journal is never compacted, however small the cache is
+const uint64_t MIN_COMPACTION_SIZE = 1024 * 1024;
+
+/* The image is rebuilt by adding each operation's data and then copying a
+   run of the previous image after it */
+struct JournalOperation {
+  BinaryArray insertedData;
+  uint64_t copyOffset;
+  uint64_t copySize;
+};
+
+struct JournalRecord {
+  uint64_t previousImageHash;
+  uint64_t imageHash;
+  uint64_t imageSize;
+  std::vector<JournalOperation> operations;
+};
+
+void serialize(JournalOperation& operation, ISerializer& s) {
+  serializeAsBinary(operation.insertedData, "insertedData", s);
+  s(operation.copyOffset, "copyOffset");
+  s(operation.copySize, "copySize");
+}
+
+void serialize(JournalRecord& record, ISerializer& s) {
+  s(record.previousImageHash, "previousImageHash");
+  s(record.imageHash, "imageHash");
+  s(record.imageSize, "imageSize");
+  s(record.operations, "operations");
+}
+
+const std::array<uint64_t, 256>& getGearTable() {
+  // Chunk boundaries must come out the same in every build, so the table is generated from a fixed seed
+  static const std::array<uint64_t, 256> table = [] {
+    std::array<uint64_t, 256> result;
+    uint64_t state = UINT64_C(0x57414C4C4554); // "WALLET"
+    for (auto& value : result) {
+      state += UINT64_C(0x9E3779B97F4A7C15);
+      uint64_t z = state;
+      z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+      z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+      value = z ^ (z >> 31);
+    }
+
+    return result;
+  }();
+
+  return table;
+}
+
+#define SIP_ROUND \
+  v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32); \
+  v2 += v3; v3 = rotl(v3, 16); v3 ^= v2; \
+  v0 += v3; v3 = rotl(v3, 21); v3 ^= v0; \
+  v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32)
+
+inline uint64_t rotl(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+/* SipHash-2-4, the chunks are hashed at memory speed where Keccak would
+   take seconds on a large cache */
+uint64_t sipHash(const uint64_t key[2], const uint8_t* data, size_t size) {
+  uint64_t v0 = key[0] ^ UINT64_C(0x736F6D6570736575);
+  uint64_t v1 = key[1] ^ UINT64_C(0x646F72616E646F6D);
+  uint64_t v2 = key[0] ^ UINT64_C(0x6C7967656E657261);
+  uint64_t v3 = key[1] ^ UINT64_C(0x7465646279746573);
+
+  const uint8_t* end = data + (size & ~static_cast<size_t>(7));
+  for (; data != end; data += 8) {
+    uint64_t m;
+    std::memcpy(&m, data, sizeof(m));
+    v3 ^= m;
+    SIP_ROUND;
+    SIP_ROUND;
+    v0 ^= m;
+  }
+
+  uint64_t last = static_cast<uint64_t>(size) << 56;
+  for (size_t i = 0; i < (size & 7); ++i) {
+    last |= static_cast<uint64_t>(data[i]) << (8 * i);
+  }
+
+  v3 ^= last;
+  SIP_ROUND;
+  SIP_ROUND;
+  v0 ^= last;
+
+  v2 ^= 0xFF;
+  SIP_ROUND;
+  SIP_ROUND;
+  SIP_ROUND;
+  SIP_ROUND;
+
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+#undef SIP_ROUND
+
+/* Keyed with the container key, which also tells a record written under an
+   old password from a damaged one */
+Crypto::Hash getRecordChecksum(const Crypto::chacha8_key& key, const Crypto::chacha8_iv& iv, const BinaryArray& data) {
+  BinaryArray buffer;
+  buffer.reserve(sizeof(key) + sizeof(iv) + data.size());
+  buffer.insert(buffer.end(), key.data, key.data + sizeof(key.data));
+  buffer.insert(buffer.end(), iv.data, iv.data + sizeof(iv.data));
+  buffer.insert(buffer.end(), data.begin(), data.end());
+
+  return Crypto::cn_fast_hash(buffer.data(), buffer.size());
+}
+
+/* On disk a record is its size, the IV, the encrypted record and the
+   checksum of the plain one */
+const uint64_t RECORD_OVERHEAD = sizeof(uint64_t) + sizeof(Crypto::chacha8_iv) + sizeof(Crypto::Hash);
+
+bool readRecord(const BinaryArray& journal, uint64_t& position, const Crypto::chacha8_key& key, JournalRecord& record) {
+  if (journal.size() - position < RECORD_OVERHEAD) {
+    return false;
+  }
+
+  uint64_t recordSize;
+  std::memcpy(&recordSize, journal.data() + position, sizeof(recordSize));
+  if (recordSize > journal.size() - position - RECORD_OVERHEAD) {
+    return false;
+  }
+
+  const uint8_t* data = journal.data() + position + sizeof(recordSize);
+
+  Crypto::chacha8_iv iv;
+  std::memcpy(iv.data, data, sizeof(iv.data));
+  data += sizeof(iv.data);
+
+  BinaryArray plainRecord(recordSize);
+  Crypto::chacha8(data, recordSize, key, iv, reinterpret_cast<char*>(plainRecord.data()));
+  data += recordSize;
+
+  Crypto::Hash checksum;
+  std::memcpy(checksum.data, data, sizeof(checksum.data));
+  if (checksum != getRecordChecksum(key, iv, plainRecord)) {
+    return false;
+  }
+
+  try {
+    Common::MemoryInputStream stream(plainRecord.data(), plainRecord.size());
+    BinaryInputStreamSerializer s(stream);
+    serialize(record, s);
+  } catch (const std::exception&) {
+    return false;
+  }
+
+  position += recordSize + RECORD_OVERHEAD;
+  return true;
+}
+
+void applyRecord(const JournalRecord& record, const BinaryArray& image, BinaryArray& nextImage) {
+  nextImage.clear();
+  nextImage.reserve(record.imageSize);
+
+  for (const auto& operation : record.operations) {
+    if (operation.copyOffset > image.size() || operation.copySize > image.size() - operation.copyOffset) {
+      throw std::runtime_error("Wallet cache journal copies past the end of the image");
+    }
+
+    nextImage.insert(nextImage.end(), operation.insertedData.begin(), operation.insertedData.end());
+    nextImage.insert(nextImage.end(), image.begin() + operation.copyOffset, image.begin() + operation.copyOffset + operation.copySize);
+  }
+
+  if (nextImage.size() != record.imageSize) {
+    throw std::runtime_error("Wallet cache journal record has wrong image size");
+  }
+}
+
+}
+
+WalletCacheJournal::WalletCacheJournal() : m_hasImage(false), m_imageHash(0), m_imageSize(0), m_journalSize(0) {
+}
+
+void WalletCacheJournal::open(const std::string& containerPath, const Crypto::chacha8_key& key) {
+  close();
+
+  m_path = containerPath + ".journal";
+  m_key = key;
+
+  const char hashKeyDomain[] = "wallet cache journal";
+  BinaryArray hashKeySeed(key.data, key.data + sizeof(key.data));
+  hashKeySeed.insert(hashKeySeed.end(), hashKeyDomain, hashKeyDomain + sizeof(hashKeyDomain) - 1);
+  Crypto::Hash hashKey = Crypto::cn_fast_hash(hashKeySeed.data(), hashKeySeed.size());
+  std::memcpy(m_hashKey, hashKey.data, sizeof(m_hashKey));
+}
+
+void WalletCacheJournal::close() {
+  m_path.clear();
+  m_hasImage = false;
+  m_imageSize = 0;
+  m_journalSize = 0;
+  m_chunks.clear();
+}
+
+size_t WalletCacheJournal::replay(BinaryArray& image) {
+  assert(!m_path.empty());
+
+  m_hasImage = false;
+
+  BinaryArray journal;
+  std::ifstream journalFile(m_path, std::ios::binary);
+  if (journalFile) {
+    journal.assign(std::istreambuf_iterator<char>(journalFile), std::istreambuf_iterator<char>());
+  }
+
+  journalFile.close();
+
+  auto chunks = splitIntoChunks(image);
+  uint64_t expectedImageHash = getImageHash(chunks);
+
+  uint64_t position = 0;
+  uint64_t validSize = 0;
+  size_t recordCount = 0;
+  BinaryArray nextImage;
+  JournalRecord record;
+
+  // Records from before the container was last written in full don't continue its image and end the replay
+  while (readRecord(journal, position, m_key, record) && record.previousImageHash == expectedImageHash) {
+    applyRecord(record, image, nextImage);
+    image.swap(nextImage);
+    expectedImageHash = record.imageHash;
+    validSize = position;
+    ++recordCount;
+  }
+
+  if (recordCount > 0) {
+    chunks = splitIntoChunks(image);
+    if (getImageHash(chunks) != expectedImageHash) {
+      throw std::runtime_error("Wallet cache journal doesn't rebuild the saved image");
+    }
+  }
+
+  if (validSize < journal.size()) {
+    truncate(validSize);
+  }
+
+  m_journalSize = validSize;
+  setImage(chunks, image.size());
+
+  return recordCount;
+}
+
+void WalletCacheJournal::reset(const BinaryArray& image) {
+  if (m_path.empty()) {
+    return;
+  }
+
+  m_hasImage = false;
+  truncate(0);
+  m_journalSize = 0;
+
+  setImage(splitIntoChunks(image), image.size());
+}
+
+void WalletCacheJournal::append(const BinaryArray& image) {
+  assert(m_hasImage);
+
+  auto chunks = splitIntoChunks(image);
+
+  JournalRecord record;
+  record.previousImageHash = m_imageHash;
+  record.imageHash = getImageHash(chunks);
+  record.imageSize = image.size();
+
+  if (record.imageHash == m_imageHash) {
+    return;
+  }
+
+  for (const auto& chunk : chunks) {
+    auto it = m_chunks.find(chunk.hash);
+    if (it == m_chunks.end()) {
+      if (record.operations.empty() || record.operations.back().copySize != 0) {
+        record.operations.emplace_back(JournalOperation{BinaryArray(), 0, 0});
+      }
+
+      auto& insertedData = record.operations.back().insertedData;
+      insertedData.insert(insertedData.end(), image.begin() + chunk.offset, image.begin() + chunk.offset + chunk.size);
+      continue;
+    }
+
+    if (!record.operations.empty()) {
+      auto& last = record.operations.back();
+      if (last.copySize == 0) {
+        last.copyOffset = it->second.offset;
+        last.copySize = chunk.size;
+        continue;
+      }
+
+      if (last.copyOffset + last.copySize == it->second.offset) {
+        last.copySize += chunk.size;
+        continue;
+      }
+    }
+
+    record.operations.emplace_back(JournalOperation{BinaryArray(), it->second.offset, chunk.size});
+  }
+
+  BinaryArray plainRecord;
+  Common::VectorOutputStream stream(plainRecord);
+  BinaryOutputStreamSerializer s(stream);
+  serialize(record, s);
+
+  Crypto::chacha8_iv iv = Crypto::rand<Crypto::chacha8_iv>();
+  uint64_t recordSize = plainRecord.size();
+
+  BinaryArray data(recordSize + RECORD_OVERHEAD);
+  uint8_t* output = data.data();
+  std::memcpy(output, &recordSize, sizeof(recordSize));
+  output += sizeof(recordSize);
+  std::memcpy(output, iv.data, sizeof(iv.data));
+  output += sizeof(iv.data);
+  Crypto::chacha8(plainRecord.data(), plainRecord.size(), m_key, iv, reinterpret_cast<char*>(output));
+  output += recordSize;
+  Crypto::Hash checksum = getRecordChecksum(m_key, iv, plainRecord);
+  std::memcpy(output, checksum.data, sizeof(checksum.data));
+
+  std::ofstream journalFile(m_path, std::ios::binary | std::ios::app);
+  journalFile.write(reinterpret_cast<const char*>(data.data()), data.size());
+  journalFile.flush();
+
+  if (!journalFile) {
+    // A torn record would hide every later one, the next save starts the journal over instead
+    m_hasImage = false;
+    throw std::runtime_error("Failed to write wallet cache journal " + m_path);
+  }
+
+  m_journalSize += data.size();
+  setImage(chunks, image.size());
+}
+
+bool WalletCacheJournal::isCompactionDue() const {
+  return m_path.empty() || !m_hasImage || m_journalSize > std::max(MIN_COMPACTION_SIZE, m_imageSize / 2);
+}
+
+/* Boundaries depend only on the bytes just before them, so data inserted in
+   the middle of the image moves a few chunks rather than all of the ones
+   after it */
+std::vector<WalletCacheJournal::Chunk> WalletCacheJournal::splitIntoChunks(const BinaryArray& image) const {
+  const auto& gearTable = getGearTable();
+  std::vector<Chunk> chunks;
+
+  uint64_t chunkStart = 0;
+  while (chunkStart < image.size()) {
+    uint64_t end = std::min<uint64_t>(image.size(), chunkStart + MAX_CHUNK_SIZE);
+    uint64_t position = std::min<uint64_t>(end, chunkStart + MIN_CHUNK_SIZE);
+    uint64_t rollingHash = 0;
+
+    for (; position < end; ++position) {
+      rollingHash = (rollingHash << 1) + gearTable[image[position]];
+      if ((rollingHash & CHUNK_BOUNDARY_MASK) == 0) {
+        ++position;
+        break;
+      }
+    }
+
+    Chunk chunk;
+    chunk.offset = chunkStart;
+    chunk.size = position - chunkStart;
+    chunk.hash = sipHash(m_hashKey, image.data() + chunk.offset, chunk.size);
+    chunks.push_back(chunk);
+
+    chunkStart = position;
+  }
+
+  return chunks;
+}
+
+uint64_t WalletCacheJournal::getImageHash(const std::vector<Chunk>& chunks) const {
+  std::vector<uint64_t> hashes;
+  hashes.reserve(chunks.size());
+  for (const auto& chunk : chunks) {
+    hashes.push_back(chunk.hash);
+  }
+
+  return sipHash(m_hashKey, reinterpret_cast<const uint8_t*>(hashes.data()), hashes.size() * sizeof(uint64_t));
+}
+
+void WalletCacheJournal::setImage(const std::vector<Chunk>& chunks, uint64_t imageSize) {
+  m_chunks.clear();
+  for (const auto& chunk : chunks) {
+    m_chunks.emplace(chunk.hash, chunk);
+  }
+
+  m_imageHash = getImageHash(chunks);
+  m_imageSize = imageSize;
+  m_hasImage = true;
+}
+
+void WalletCacheJournal::truncate(uint64_t size) {
+  boost::system::error_code ec;
+  if (size == 0) {
+    boost::filesystem::remove(m_path, ec);
+  } else {
+    boost::filesystem::resize_file(m_path, size, ec);
+  }
+
+  if (ec) {
+    throw std::runtime_error("Failed to truncate wallet cache journal " + m_path + ": " + ec.message());
+  }
+}
+
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2018, The Calex Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CryptoNote.h"
+#include "crypto/chacha8.h"
+
+namespace CryptoNote {
+
+/* Append-only log of wallet cache saves, kept in a file next to the
+   container. The serialized cache is split into content defined chunks,
+   and each save only stores the chunks that weren't in the previous one,
+   so its size follows what changed instead of the size of the cache.
+
+   Records are encrypted and authenticated with the container key. Each one
+   names the image it applies to, so a journal that doesn't continue the
+   image in the container, such as one left behind by an interrupted
+   compaction, is dropped instead of being applied */
+class WalletCacheJournal {
+public:
+  WalletCacheJournal();
+
+  void open(const std::string& containerPath, const Crypto::chacha8_key& key);
+  void close();
+
+  /* Applies the saved records to the cache image from the container, which
+     then holds the latest save. Returns the number of records applied. A
+     torn or foreign tail is cut off, a chain that doesn't add up throws */
+  size_t replay(BinaryArray& image);
+
+  /* Starts an empty journal after the image was written to the container */
+  void reset(const BinaryArray& image);
+  void append(const BinaryArray& image);
+
+  /* True when the next save should be written to the container in full,
+     because the journal outgrew the cache or has nothing to build on */
+  bool isCompactionDue() const;
+
+private:
+  struct Chunk {
+    uint64_t hash;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  std::vector<Chunk> splitIntoChunks(const BinaryArray& image) const;
+  uint64_t getImageHash(const std::vector<Chunk>& chunks) const;
+
+  void setImage(const std::vector<Chunk>& chunks, uint64_t imageSize);
+  void truncate(uint64_t size);
+
+  std::string m_path;
+  Crypto::chacha8_key m_key;
+  // Chunks are told apart by a hash keyed from the container key, so others can't make two collide
+  uint64_t m_hashKey[2];
+  bool m_hasImage;
+  uint64_t m_imageHash;
+  uint64_t m_imageSize;
+  uint64_t m_journalSize;
+  std::unordered_map<uint64_t, Chunk> m_chunks;
+};
+
+}
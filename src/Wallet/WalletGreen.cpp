@@ -30,6 +30,7 @@
 #include "Common/StreamTools.h"
 #include "Common/StringOutputStream.h"
 #include "Common/StringTools.h"
+#include "Common/VectorOutputStream.h"
 #include "CryptoNoteCore/Account.h"
 #include "CryptoNoteCore/Currency.h"
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
@@ -127,6 +128,7 @@ WalletGreen::WalletGreen(System::Dispatcher& dispatcher, const Currency& currenc
   m_node(node),
   m_logger(logger, "WalletGreen/empty"),
   m_stopped(false),
+  m_spendableOutputsOutdated(true),
   m_blockchainSynchronizerStarted(false),
   m_blockchainSynchronizer(node, logger, currency.genesisBlockHash()),
   m_synchronizer(currency, logger, m_blockchainSynchronizer, node),
@@ -206,6 +208,7 @@ void WalletGreen::doShutdown() {
   m_blockchainSynchronizer.removeObserver(this);
 
   m_containerStorage.close();
+  m_cacheJournal.close();
   m_walletsContainer.clear();
 
   clearCaches(true, true);
@@ -265,6 +268,9 @@ void WalletGreen::clearCaches(bool clearTransactions, bool clearCachedData) {
 
     m_uncommitedTransactions.clear();
     m_unlockTransactionsJob.clear();
+    m_spendableOutputs.clear();
+    m_changedOutputContainers.clear();
+    m_spendableOutputsOutdated = true;
     m_actualBalance = 0;
     m_pendingBalance = 0;
     m_fusionTxsCache.clear();
@@ -370,6 +376,8 @@ void WalletGreen::initWithKeys(const std::string& path, const std::string& passw
   m_containerStorage.swap(newStorage);
   incNextIv();
 
+  m_cacheJournal.open(path, m_key);
+
   m_viewPublicKey = viewPublicKey;
   m_viewSecretKey = viewSecretKey;
   m_password = password;
@@ -393,7 +401,11 @@ void WalletGreen::save(WalletSaveLevel saveLevel, const std::string& extra) {
   stopBlockchainSynchronizer();
 
   try {
-    saveWalletCache(m_containerStorage, m_key, saveLevel, extra);
+    if (m_cacheJournal.isCompactionDue()) {
+      saveWalletCache(m_containerStorage, m_key, saveLevel, extra);
+    } else {
+      appendWalletCache(saveLevel, extra);
+    }
   } catch (const std::exception& e) {
     m_logger(ERROR, BRIGHT_RED) << "Failed to save container: " << e.what();
     startBlockchainSynchronizer();
@@ -462,6 +474,7 @@ void WalletGreen::load(const std::string& path, const std::string& password, std
   stopBlockchainSynchronizer();
 
   generate_chacha8_key(password, m_key);
+  m_cacheJournal.open(path, m_key);
 
   std::ifstream walletFileStream(path, std::ios_base::binary);
   int version = walletFileStream.peek();
@@ -595,6 +608,9 @@ void WalletGreen::loadWalletCache(std::unordered_set<Crypto::PublicKey>& addedKe
   BinaryArray contanerData;
   loadAndDecryptContainerData(m_containerStorage, m_key, contanerData);
 
+  size_t journalRecordCount = m_cacheJournal.replay(contanerData);
+  m_logger(DEBUGGING) << "Applied " << journalRecordCount << " saves from container cache journal";
+
   WalletSerializerV2 s(
     *this,
     m_viewPublicKey,
@@ -622,6 +638,35 @@ void WalletGreen::loadWalletCache(std::unordered_set<Crypto::PublicKey>& addedKe
 void WalletGreen::saveWalletCache(ContainerStorage& storage, const Crypto::chacha8_key& key, WalletSaveLevel saveLevel, const std::string& extra) {
   m_logger(DEBUGGING) << "Saving cache...";
 
+  BinaryArray containerData;
+  serializeWalletCache(saveLevel, extra, containerData);
+
+  encryptAndSaveContainerData(storage, key, containerData.data(), containerData.size());
+  storage.flush();
+
+  // The journal only holds changes to our own container, and they are all in it now
+  if (&storage == &m_containerStorage) {
+    m_cacheJournal.reset(containerData);
+  }
+
+  m_extra = extra;
+
+  m_logger(DEBUGGING) << "Container saving finished";
+}
+
+void WalletGreen::appendWalletCache(WalletSaveLevel saveLevel, const std::string& extra) {
+  m_logger(DEBUGGING) << "Appending cache to journal...";
+
+  BinaryArray containerData;
+  serializeWalletCache(saveLevel, extra, containerData);
+  m_cacheJournal.append(containerData);
+
+  m_extra = extra;
+
+  m_logger(DEBUGGING) << "Container cache journal updated";
+}
+
+void WalletGreen::serializeWalletCache(WalletSaveLevel saveLevel, const std::string& extra, BinaryArray& containerData) {
   WalletTransactions transactions;
   WalletTransfers transfers;
 
@@ -642,8 +687,7 @@ void WalletGreen::saveWalletCache(ContainerStorage& storage, const Crypto::chach
     });
   }
 
-  std::string containerData;
-  Common::StringOutputStream containerStream(containerData);
+  Common::VectorOutputStream containerStream(containerData);
 
   WalletSerializerV2 s(
     *this,
@@ -662,13 +706,6 @@ void WalletGreen::saveWalletCache(ContainerStorage& storage, const Crypto::chach
   );
 
   s.save(containerStream, saveLevel);
-
-  encryptAndSaveContainerData(storage, key, containerData.data(), containerData.size());
-  storage.flush();
-
-  m_extra = extra;
-
-  m_logger(DEBUGGING) << "Container saving finished";
 }
 
 void WalletGreen::copyContainerStorageKeys(ContainerStorage& src, const chacha8_key& srcKey, ContainerStorage& dst, const chacha8_key& dstKey) {
@@ -924,13 +961,19 @@ void WalletGreen::changePassword(const std::string& oldPassword, const std::stri
   Crypto::chacha8_key newKey;
   Crypto::generate_chacha8_key(newPassword, newKey);
 
-  m_containerStorage.atomicUpdate([this, newKey](ContainerStorage& newStorage) {
+  // The journal is encrypted with the old key, so the cache is rewritten with its changes applied
+  BinaryArray containerData;
+  bool hasCache = m_containerStorage.suffixSize() > 0;
+  if (hasCache) {
+    loadAndDecryptContainerData(m_containerStorage, m_key, containerData);
+    m_cacheJournal.replay(containerData);
+  }
+
+  m_containerStorage.atomicUpdate([this, newKey, hasCache, &containerData](ContainerStorage& newStorage) {
     copyContainerStoragePrefix(m_containerStorage, m_key, newStorage, newKey);
     copyContainerStorageKeys(m_containerStorage, m_key, newStorage, newKey);
 
-    if (m_containerStorage.suffixSize() > 0) {
-      BinaryArray containerData;
-      loadAndDecryptContainerData(m_containerStorage, m_key, containerData);
+    if (hasCache) {
       encryptAndSaveContainerData(newStorage, newKey, containerData.data(), containerData.size());
     }
   });
@@ -938,6 +981,11 @@ void WalletGreen::changePassword(const std::string& oldPassword, const std::stri
   m_key = newKey;
   m_password = newPassword;
 
+  m_cacheJournal.open(m_path, m_key);
+  if (hasCache) {
+    m_cacheJournal.reset(containerData);
+  }
+
   m_logger(INFO, BRIGHT_WHITE) << "Container password changed";
 }
 
@@ -1388,6 +1436,8 @@ void WalletGreen::deleteAddress(const std::string& address) {
   m_synchronizer.removeSubscription(pubAddr);
 
   deleteContainerFromUnlockTransactionJobs(it->container);
+  m_spendableOutputs.get<TransfersContainerIndex>().erase(it->container);
+  m_changedOutputContainers.erase(it->container);
   std::vector<size_t> deletedTransactions;
   std::vector<size_t> updatedTransactions = deleteTransfersForAddress(address, deletedTransactions);
   deleteFromUncommitedTransactions(deletedTransactions);
@@ -1554,24 +1604,19 @@ size_t WalletGreen::transfer(const TransactionParameters& transactionParameters)
 
 uint64_t WalletGreen::getBalanceMinusDust(const std::vector<std::string>& addresses)
 {
-    std::vector<WalletOuts> wallets = pickWallets(addresses);
-    std::vector<OutputToTransfer> unused;
+    uint64_t dustThreshold = m_currency.defaultDustThreshold(m_node.getLastKnownBlockHeight());
+    uint64_t balance = 0;
 
-    /* We want to get the full balance, so don't stop getting outputs early */
-    uint64_t needed = std::numeric_limits<uint64_t>::max();
+    /* Don't include dust outputs */
+    for (const SpendableOutput* output : pickSpendableOutputs(addresses, dustThreshold + 1, std::numeric_limits<uint64_t>::max()))
+    {
+        balance += output->out.amount;
+    }
 
-    return selectTransfers
-    (
-        needed,
-        /* Don't include dust outputs */
-        false,
-        m_currency.defaultDustThreshold(m_node.getLastKnownBlockHeight()),
-        std::move(wallets),
-        unused
-    );
+    return balance;
 }
 
-void WalletGreen::prepareTransaction(std::vector<WalletOuts>&& wallets,
+void WalletGreen::prepareTransaction(const std::vector<std::string>& sourceAddresses,
   const std::vector<WalletOrder>& orders,
   uint64_t fee,
   uint16_t mixIn,
@@ -1585,7 +1630,7 @@ void WalletGreen::prepareTransaction(std::vector<WalletOuts>&& wallets,
   preparedTransaction.neededMoney = countNeededMoney(preparedTransaction.destinations, fee);
 
   std::vector<OutputToTransfer> selectedTransfers;
-  uint64_t foundMoney = selectTransfers(preparedTransaction.neededMoney, mixIn == 0, m_currency.defaultDustThreshold(m_node.getLastKnownBlockHeight()), std::move(wallets), selectedTransfers);
+  uint64_t foundMoney = selectTransfers(preparedTransaction.neededMoney, mixIn == 0, m_currency.defaultDustThreshold(m_node.getLastKnownBlockHeight()), sourceAddresses, selectedTransfers);
 
   if (foundMoney < preparedTransaction.neededMoney) {
     m_logger(ERROR, BRIGHT_RED) << "Failed to create transaction: not enough money. Needed " << m_currency.formatAmount(preparedTransaction.neededMoney) <<
@@ -1809,15 +1854,8 @@ size_t WalletGreen::doTransfer(const TransactionParameters& transactionParameter
   CryptoNote::AccountPublicAddress changeDestination = getChangeDestination(transactionParameters.changeDestination, transactionParameters.sourceAddresses);
   m_logger(DEBUGGING) << "Change address " << m_currency.accountAddressAsString(changeDestination);
 
-  std::vector<WalletOuts> wallets;
-  if (!transactionParameters.sourceAddresses.empty()) {
-    wallets = pickWallets(transactionParameters.sourceAddresses);
-  } else {
-    wallets = pickWalletsWithMoney();
-  }
-
   PreparedTransaction preparedTransaction;
-  prepareTransaction(std::move(wallets),
+  prepareTransaction(transactionParameters.sourceAddresses,
     transactionParameters.destinations,
     transactionParameters.fee,
     transactionParameters.mixIn,
@@ -1850,16 +1888,9 @@ PreparedTransaction WalletGreen::formTransaction(const TransactionParameters &se
 
   CryptoNote::AccountPublicAddress changeDestination = getChangeDestination(sendingTransaction.changeDestination, sendingTransaction.sourceAddresses);
 
-  std::vector<WalletOuts> wallets;
-  if (!sendingTransaction.sourceAddresses.empty()) {
-    wallets = pickWallets(sendingTransaction.sourceAddresses);
-  } else {
-    wallets = pickWalletsWithMoney();
-  }
-
   PreparedTransaction preparedTransaction;
   prepareTransaction(
-    std::move(wallets),
+    sendingTransaction.sourceAddresses,
     sendingTransaction.destinations,
     sendingTransaction.fee,
     sendingTransaction.mixIn,
@@ -1906,16 +1937,9 @@ size_t WalletGreen::makeTransaction(const TransactionParameters& sendingTransact
   CryptoNote::AccountPublicAddress changeDestination = getChangeDestination(sendingTransaction.changeDestination, sendingTransaction.sourceAddresses);
   m_logger(DEBUGGING) << "Change address " << m_currency.accountAddressAsString(changeDestination);
 
-  std::vector<WalletOuts> wallets;
-  if (!sendingTransaction.sourceAddresses.empty()) {
-    wallets = pickWallets(sendingTransaction.sourceAddresses);
-  } else {
-    wallets = pickWalletsWithMoney();
-  }
-
   PreparedTransaction preparedTransaction;
   prepareTransaction(
-    std::move(wallets),
+    sendingTransaction.sourceAddresses,
     sendingTransaction.destinations,
     sendingTransaction.fee,
     sendingTransaction.mixIn,
@@ -2501,87 +2525,123 @@ uint64_t WalletGreen::selectTransfers(
   uint64_t neededMoney,
   bool dust,
   uint64_t dustThreshold,
-  std::vector<WalletOuts>&& wallets,
+  const std::vector<std::string>& addresses,
   std::vector<OutputToTransfer>& selectedTransfers) {
 
   uint64_t foundMoney = 0;
 
-  typedef std::pair<WalletRecord*, TransactionOutputInformation> OutputData;
-  std::vector<OutputData> dustOutputs;
-  std::vector<OutputData> walletOuts;
-  for (auto walletIt = wallets.begin(); walletIt != wallets.end(); ++walletIt) {
-    for (auto outIt = walletIt->outs.begin(); outIt != walletIt->outs.end(); ++outIt) {
-      if (outIt->amount > dustThreshold) {
-        walletOuts.emplace_back(std::piecewise_construct, std::forward_as_tuple(walletIt->wallet), std::forward_as_tuple(*outIt));
-      } else if (dust) {
-        dustOutputs.emplace_back(std::piecewise_construct, std::forward_as_tuple(walletIt->wallet), std::forward_as_tuple(*outIt));
-      }
-    }
+  // Outputs of the whole container are drawn from the index in place, so its dust outputs are skipped while drawing
+  updateSpendableOutputs();
+  const auto& containerOuts = m_spendableOutputs.get<RandomAccessIndex>();
+  std::vector<const SpendableOutput*> addressOuts;
+  if (!addresses.empty()) {
+    addressOuts = pickSpendableOutputs(addresses, dustThreshold + 1, std::numeric_limits<uint64_t>::max());
   }
 
-  ShuffleGenerator<size_t, Crypto::random_engine<size_t>> indexGenerator(walletOuts.size());
+  ShuffleGenerator<size_t, Crypto::random_engine<size_t>> indexGenerator(addresses.empty() ? containerOuts.size() : addressOuts.size());
   while (foundMoney < neededMoney && !indexGenerator.empty()) {
-    auto& out = walletOuts[indexGenerator()];
-    foundMoney += out.second.amount;
-    selectedTransfers.emplace_back(OutputToTransfer{ std::move(out.second), std::move(out.first) });
+    size_t index = indexGenerator();
+    const SpendableOutput& out = addresses.empty() ? containerOuts[index] : *addressOuts[index];
+    if (out.getAmount() > dustThreshold) {
+      foundMoney += out.getAmount();
+      selectedTransfers.emplace_back(OutputToTransfer{ out.out, out.wallet });
+    }
   }
 
-  if (dust && !dustOutputs.empty()) {
-    ShuffleGenerator<size_t, Crypto::random_engine<size_t>> dustIndexGenerator(dustOutputs.size());
-    do {
-      auto& out = dustOutputs[dustIndexGenerator()];
-      foundMoney += out.second.amount;
-      selectedTransfers.emplace_back(OutputToTransfer{ std::move(out.second), std::move(out.first) });
-    } while (foundMoney < neededMoney && !dustIndexGenerator.empty());
+  if (dust) {
+    std::vector<const SpendableOutput*> dustOutputs = pickSpendableOutputs(addresses, 0, dustThreshold + 1);
+    if (!dustOutputs.empty()) {
+      ShuffleGenerator<size_t, Crypto::random_engine<size_t>> dustIndexGenerator(dustOutputs.size());
+      do {
+        const SpendableOutput& out = *dustOutputs[dustIndexGenerator()];
+        foundMoney += out.getAmount();
+        selectedTransfers.emplace_back(OutputToTransfer{ out.out, out.wallet });
+      } while (foundMoney < neededMoney && !dustIndexGenerator.empty());
+    }
   }
 
   return foundMoney;
 };
 
-std::vector<WalletGreen::WalletOuts> WalletGreen::pickWalletsWithMoney() const {
-  auto& walletsIndex = m_walletsContainer.get<RandomAccessIndex>();
+/* Reads the unlocked outputs of the containers whose balance changed since
+   the last call, the rest of the index is left as it is */
+void WalletGreen::updateSpendableOutputs() const {
+  if (m_spendableOutputsOutdated) {
+    m_spendableOutputs.clear();
+    m_changedOutputContainers.clear();
+    for (const auto& wallet : m_walletsContainer.get<RandomAccessIndex>()) {
+      m_changedOutputContainers.insert(wallet.container);
+    }
+
+    m_spendableOutputsOutdated = false;
+  }
+
+  if (m_changedOutputContainers.empty()) {
+    return;
+  }
 
-  std::vector<WalletOuts> walletOuts;
-  for (const auto& wallet: walletsIndex) {
-    if (wallet.actualBalance == 0) {
+  m_spendableOutputs.get<RandomAccessIndex>().remove_if([this](const SpendableOutput& output) {
+    return m_changedOutputContainers.count(output.container) != 0;
+  });
+
+  auto& walletsIndex = m_walletsContainer.get<TransfersContainerIndex>();
+  for (ITransfersContainer* container : m_changedOutputContainers) {
+    auto walletIt = walletsIndex.find(container);
+    if (walletIt == walletsIndex.end() || walletIt->actualBalance == 0) {
       continue;
     }
 
-    ITransfersContainer* container = wallet.container;
+    std::vector<TransactionOutputInformation> outs;
+    container->getOutputs(outs, ITransfersContainer::IncludeKeyUnlocked);
+    for (auto& out : outs) {
+      m_spendableOutputs.get<RandomAccessIndex>().push_back(SpendableOutput{ std::move(out), const_cast<WalletRecord*>(&*walletIt), container });
+    }
+  }
+
+  m_changedOutputContainers.clear();
+}
+
+size_t WalletGreen::getSpendableOutputCount(const std::vector<std::string>& addresses) const {
+  updateSpendableOutputs();
 
-    WalletOuts outs;
-    container->getOutputs(outs.outs, ITransfersContainer::IncludeKeyUnlocked);
-    outs.wallet = const_cast<WalletRecord *>(&wallet);
+  if (addresses.empty()) {
+    return m_spendableOutputs.size();
+  }
 
-    walletOuts.push_back(std::move(outs));
-  };
+  size_t count = 0;
+  for (const auto& address : addresses) {
+    count += m_spendableOutputs.get<TransfersContainerIndex>().count(getWalletRecord(address).container);
+  }
 
-  return walletOuts;
+  return count;
 }
 
-WalletGreen::WalletOuts WalletGreen::pickWallet(const std::string& address) const {
-  const auto& wallet = getWalletRecord(address);
+std::vector<const SpendableOutput*> WalletGreen::pickSpendableOutputs(const std::vector<std::string>& addresses,
+  uint64_t minAmount, uint64_t maxAmount) const {
 
-  ITransfersContainer* container = wallet.container;
-  WalletOuts outs;
-  container->getOutputs(outs.outs, ITransfersContainer::IncludeKeyUnlocked);
-  outs.wallet = const_cast<WalletRecord *>(&wallet);
+  updateSpendableOutputs();
 
-  return outs;
-}
+  std::vector<const SpendableOutput*> outputs;
+  if (addresses.empty()) {
+    auto& amountIndex = m_spendableOutputs.get<AmountIndex>();
+    for (auto it = amountIndex.lower_bound(minAmount); it != amountIndex.end() && it->getAmount() < maxAmount; ++it) {
+      outputs.push_back(&*it);
+    }
 
-std::vector<WalletGreen::WalletOuts> WalletGreen::pickWallets(const std::vector<std::string>& addresses) const {
-  std::vector<WalletOuts> wallets;
-  wallets.reserve(addresses.size());
+    return outputs;
+  }
 
-  for (const auto& address: addresses) {
-    WalletOuts wallet = pickWallet(address);
-    if (!wallet.outs.empty()) {
-      wallets.emplace_back(std::move(wallet));
+  auto& containerIndex = m_spendableOutputs.get<TransfersContainerIndex>();
+  for (const auto& address : addresses) {
+    auto range = containerIndex.equal_range(getWalletRecord(address).container);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->getAmount() >= minAmount && it->getAmount() < maxAmount) {
+        outputs.push_back(&*it);
+      }
     }
   }
 
-  return wallets;
+  return outputs;
 }
 
 std::vector<CryptoNote::WalletGreen::ReceiverAmounts> WalletGreen::splitDestinations(const std::vector<CryptoNote::WalletTransfer>& destinations,
@@ -2827,6 +2887,9 @@ void WalletGreen::onSynchronizationProgressUpdated(uint32_t processedBlockCount,
 
   uint32_t currentHeight = processedBlockCount - 1;
   unlockBalances(currentHeight);
+
+  // Outputs unlock by height without an unlock job too (soft lock, unlock time), read every container again
+  m_spendableOutputsOutdated = true;
 }
 
 void WalletGreen::onSynchronizationCompleted() {
@@ -2870,6 +2933,7 @@ void WalletGreen::blocksRollback(uint32_t blockIndex) {
 
   auto& blockHeightIndex = m_blockchain.get<BlockHeightIndex>();
   blockHeightIndex.erase(std::next(blockHeightIndex.begin(), blockIndex), blockHeightIndex.end());
+  m_spendableOutputsOutdated = true;
 }
 
 void WalletGreen::onTransactionDeleteBegin(const Crypto::PublicKey& viewPublicKey, Crypto::Hash transactionHash) {
@@ -3122,10 +3186,16 @@ void WalletGreen::addUnconfirmedTransaction(const ITransactionReader& transactio
     throw std::system_error(ec, "Failed to add unconfirmed transaction");
   }
 
+  // The spent outputs leave the index now, the balance update only comes once the sending call returns
+  markTransactionInputsChanged(transaction.getTransactionHash());
+
   m_logger(DEBUGGING) << "Unconfirmed transaction added to BlockchainSynchronizer, hash " << transaction.getTransactionHash();
 }
 
 void WalletGreen::removeUnconfirmedTransaction(const Crypto::Hash& transactionHash) {
+  // Found before removal, the containers forget the inputs along with the transaction
+  markTransactionInputsChanged(transactionHash);
+
   System::RemoteContext<void> context(m_dispatcher, [this, &transactionHash] {
     m_blockchainSynchronizer.removeUnconfirmedTransaction(transactionHash).get();
   });
@@ -3134,6 +3204,14 @@ void WalletGreen::removeUnconfirmedTransaction(const Crypto::Hash& transactionHa
   m_logger(DEBUGGING) << "Unconfirmed transaction removed from BlockchainSynchronizer, hash " << transactionHash;
 }
 
+void WalletGreen::markTransactionInputsChanged(const Crypto::Hash& transactionHash) {
+  for (const auto& wallet : m_walletsContainer) {
+    if (!wallet.container->getTransactionInputs(transactionHash, ITransfersContainer::IncludeTypeAll).empty()) {
+      m_changedOutputContainers.insert(wallet.container);
+    }
+  }
+}
+
 void WalletGreen::updateBalance(CryptoNote::ITransfersContainer* container) {
   auto it = m_walletsContainer.get<TransfersContainerIndex>().find(container);
 
@@ -3141,6 +3219,8 @@ void WalletGreen::updateBalance(CryptoNote::ITransfersContainer* container) {
     return;
   }
 
+  m_changedOutputContainers.insert(container);
+
   uint64_t actual = container->balance(ITransfersContainer::IncludeAllUnlocked);
   uint64_t pending = container->balance(ITransfersContainer::IncludeAllLocked);
 
@@ -3425,21 +3505,19 @@ IFusionManager::EstimateResult WalletGreen::estimate(uint64_t threshold, const s
   validateSourceAddresses(sourceAddresses);
 
   IFusionManager::EstimateResult result{0, 0};
-  auto walletOuts = sourceAddresses.empty() ? pickWalletsWithMoney() : pickWallets(sourceAddresses);
+  uint32_t height = m_node.getLastKnownBlockHeight();
   std::array<size_t, std::numeric_limits<uint64_t>::digits10 + 1> bucketSizes;
   bucketSizes.fill(0);
-  for (size_t walletIndex = 0; walletIndex < walletOuts.size(); ++walletIndex) {
-    for (auto& out : walletOuts[walletIndex].outs) {
-      uint8_t powerOfTen = 0;
-      if (m_currency.isAmountApplicableInFusionTransactionInput(out.amount, threshold, powerOfTen, m_node.getLastKnownBlockHeight())) {
-        assert(powerOfTen < std::numeric_limits<uint64_t>::digits10 + 1);
-        bucketSizes[powerOfTen]++;
-      }
+  for (const SpendableOutput* out : pickSpendableOutputs(sourceAddresses, m_currency.defaultFusionDustThreshold(height), threshold)) {
+    uint8_t powerOfTen = 0;
+    if (m_currency.isAmountApplicableInFusionTransactionInput(out->getAmount(), threshold, powerOfTen, height)) {
+      assert(powerOfTen < std::numeric_limits<uint64_t>::digits10 + 1);
+      bucketSizes[powerOfTen]++;
     }
-
-    result.totalOutputCount += walletOuts[walletIndex].outs.size();
   }
 
+  result.totalOutputCount = getSpendableOutputCount(sourceAddresses);
+
   for (auto bucketSize : bucketSizes) {
     if (bucketSize >= m_currency.fusionTxMinInputCount()) {
       result.fusionReadyCount += bucketSize;
@@ -3453,17 +3531,15 @@ std::vector<WalletGreen::OutputToTransfer> WalletGreen::pickRandomFusionInputs(c
   uint64_t threshold, size_t minInputCount, size_t maxInputCount) {
 
   std::vector<WalletGreen::OutputToTransfer> allFusionReadyOuts;
-  auto walletOuts = addresses.empty() ? pickWalletsWithMoney() : pickWallets(addresses);
+  uint32_t height = m_node.getLastKnownBlockHeight();
   std::array<size_t, std::numeric_limits<uint64_t>::digits10 + 1> bucketSizes;
   bucketSizes.fill(0);
-  for (size_t walletIndex = 0; walletIndex < walletOuts.size(); ++walletIndex) {
-    for (auto& out : walletOuts[walletIndex].outs) {
-      uint8_t powerOfTen = 0;
-      if (m_currency.isAmountApplicableInFusionTransactionInput(out.amount, threshold, powerOfTen, m_node.getLastKnownBlockHeight())) {
-        allFusionReadyOuts.push_back({std::move(out), walletOuts[walletIndex].wallet});
-        assert(powerOfTen < std::numeric_limits<uint64_t>::digits10 + 1);
-        bucketSizes[powerOfTen]++;
-      }
+  for (const SpendableOutput* out : pickSpendableOutputs(addresses, m_currency.defaultFusionDustThreshold(height), threshold)) {
+    uint8_t powerOfTen = 0;
+    if (m_currency.isAmountApplicableInFusionTransactionInput(out->getAmount(), threshold, powerOfTen, height)) {
+      allFusionReadyOuts.push_back({out->out, out->wallet});
+      assert(powerOfTen < std::numeric_limits<uint64_t>::digits10 + 1);
+      bucketSizes[powerOfTen]++;
     }
   }
 
@@ -21,8 +21,10 @@
 
 #include <queue>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "IFusionManager.h"
+#include "WalletCacheJournal.h"
 #include "WalletIndices.h"
 
 #include "Logging/LoggerRef.h"
@@ -111,6 +113,7 @@ public:
                         const Crypto::SecretKey &viewSecretKey,
                         const uint64_t scanHeight,
                         const bool newAddress);
+  // Unlocked balance above the dust threshold, no addresses means the whole wallet
   uint64_t getBalanceMinusDust(const std::vector<std::string>& addresses);
 
   virtual void start() override;
@@ -168,11 +171,6 @@ protected:
     std::vector<uint64_t> amounts;
   };
 
-  struct WalletOuts {
-    WalletRecord* wallet;
-    std::vector<TransactionOutputInformation> outs;
-  };
-
   typedef std::pair<WalletTransfers::const_iterator, WalletTransfers::const_iterator> TransfersRange;
 
   struct AddressAmounts {
@@ -223,9 +221,10 @@ protected:
   virtual void onTransactionDeleteEnd(const Crypto::PublicKey& viewPublicKey, Crypto::Hash transactionHash) override;
   void transactionDeleteEnd(Crypto::Hash transactionHash);
 
-  std::vector<WalletOuts> pickWalletsWithMoney() const;
-  WalletOuts pickWallet(const std::string& address) const;
-  std::vector<WalletOuts> pickWallets(const std::vector<std::string>& addresses) const;
+  void updateSpendableOutputs() const;
+  size_t getSpendableOutputCount(const std::vector<std::string>& addresses) const;
+  // Unlocked outputs of the addresses, or of the whole container when no address is given, with amounts in [minAmount, maxAmount)
+  std::vector<const SpendableOutput*> pickSpendableOutputs(const std::vector<std::string>& addresses, uint64_t minAmount, uint64_t maxAmount) const;
 
   void updateBalance(CryptoNote::ITransfersContainer* container);
   void unlockBalances(uint32_t height);
@@ -242,7 +241,7 @@ protected:
   bool isFusionTransaction(const WalletTransaction& walletTx) const;
 
   
-  void prepareTransaction(std::vector<WalletOuts>&& wallets,
+  void prepareTransaction(const std::vector<std::string>& sourceAddresses,
     const std::vector<WalletOrder>& orders,
     uint64_t fee,
     uint16_t mixIn,
@@ -277,7 +276,7 @@ protected:
   uint64_t selectTransfers(uint64_t needeMoney,
     bool dust,
     uint64_t dustThreshold,
-    std::vector<WalletOuts>&& wallets,
+    const std::vector<std::string>& addresses,
     std::vector<OutputToTransfer>& selectedTransfers);
 
   std::vector<ReceiverAmounts> splitDestinations(const std::vector<WalletTransfer>& destinations,
@@ -312,6 +311,7 @@ protected:
   void stopBlockchainSynchronizer();
   void addUnconfirmedTransaction(const ITransactionReader& transaction);
   void removeUnconfirmedTransaction(const Crypto::Hash& transactionHash);
+  void markTransactionInputsChanged(const Crypto::Hash& transactionHash);
 
   void copyContainerStorageKeys(ContainerStorage& src, const Crypto::chacha8_key& srcKey, ContainerStorage& dst, const Crypto::chacha8_key& dstKey);
   static void copyContainerStoragePrefix(ContainerStorage& src, const Crypto::chacha8_key& srcKey, ContainerStorage& dst, const Crypto::chacha8_key& dstKey);
@@ -323,6 +323,8 @@ protected:
   void loadContainerStorage(const std::string& path);
   void loadWalletCache(std::unordered_set<Crypto::PublicKey>& addedKeys, std::unordered_set<Crypto::PublicKey>& deletedKeys, std::string& extra);
   void saveWalletCache(ContainerStorage& storage, const Crypto::chacha8_key& key, WalletSaveLevel saveLevel, const std::string& extra);
+  void appendWalletCache(WalletSaveLevel saveLevel, const std::string& extra);
+  void serializeWalletCache(WalletSaveLevel saveLevel, const std::string& extra, BinaryArray& containerData);
   void subscribeWallets();
 
   std::vector<OutputToTransfer> pickRandomFusionInputs(const std::vector<std::string>& addresses,
@@ -364,7 +366,13 @@ protected:
 
   WalletsContainer m_walletsContainer;
   ContainerStorage m_containerStorage;
+  WalletCacheJournal m_cacheJournal;
   UnlockTransactionJobs m_unlockTransactionsJob;
+  // Unlocked outputs ordered by amount, containers whose balance changed are read again before the next use,
+  // every container is read again after a height change
+  mutable SpendableOutputs m_spendableOutputs;
+  mutable std::unordered_set<ITransfersContainer*> m_changedOutputContainers;
+  mutable bool m_spendableOutputsOutdated;
   WalletTransactions m_transactions;
   WalletTransfers m_transfers; //sorted
   mutable std::unordered_map<size_t, bool> m_fusionTxsCache; // txIndex -> isFusion
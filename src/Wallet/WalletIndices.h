@@ -29,6 +29,7 @@
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/composite_key.hpp>
 #include <boost/multi_index/member.hpp>
+#include <boost/multi_index/mem_fun.hpp>
 
 #include "Common/FileMappedVector.h"
 #include "crypto/chacha8.h"
@@ -60,6 +61,7 @@ struct TransfersContainerIndex {};
 
 struct WalletIndex {};
 struct TransactionOutputIndex {};
+struct AmountIndex {};
 struct BlockHeightIndex {};
 
 struct TransactionHashIndex {};
@@ -108,6 +110,29 @@ typedef boost::multi_index_container <
   >
 > WalletTransactions;
 
+/* Unlocked output of one of the wallets. The container is kept next to the
+   output so the outputs of a container can be replaced when it changes */
+struct SpendableOutput {
+  TransactionOutputInformation out;
+  WalletRecord* wallet;
+  CryptoNote::ITransfersContainer* container;
+
+  uint64_t getAmount() const { return out.amount; }
+};
+
+typedef boost::multi_index_container <
+  SpendableOutput,
+  boost::multi_index::indexed_by <
+    boost::multi_index::random_access < boost::multi_index::tag <RandomAccessIndex> >,
+    boost::multi_index::ordered_non_unique < boost::multi_index::tag <AmountIndex>,
+      boost::multi_index::const_mem_fun<SpendableOutput, uint64_t, &SpendableOutput::getAmount>
+    >,
+    boost::multi_index::hashed_non_unique < boost::multi_index::tag <TransfersContainerIndex>,
+      BOOST_MULTI_INDEX_MEMBER(SpendableOutput, CryptoNote::ITransfersContainer*, container)
+    >
+  >
+> SpendableOutputs;
+
 typedef Common::FileMappedVector<EncryptedWalletRecord> ContainerStorage;
 typedef std::pair<size_t, CryptoNote::WalletTransfer> TransactionTransferPair;
 typedef std::vector<TransactionTransferPair> WalletTransfers;
@@ -57,6 +57,17 @@ public:
     callback(std::error_code());
   };
 
+  virtual void queryBlockFilters(std::vector<Crypto::Hash>&& knownBlockIds, uint64_t timestamp, std::vector<CryptoNote::BlockFilter>& filters,
+    uint32_t& startHeight, const Callback& callback) override {
+    startHeight = 0;
+    callback(std::error_code());
+  }
+
+  virtual void getBlocksLite(std::vector<Crypto::Hash>&& blockHashes, std::vector<CryptoNote::BlockShortEntry>& blocks,
+    const Callback& callback) override {
+    callback(std::error_code());
+  }
+
   virtual void getPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
           std::vector<std::unique_ptr<CryptoNote::ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds, const Callback& callback) override {
     isBcActual = true;
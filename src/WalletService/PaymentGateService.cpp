@@ -92,6 +92,10 @@ bool PaymentGateService::init(int argc, char** argv) {
   return true;
 }
 
+void PaymentGateService::suspendLogging() {
+  fileLogger.suspendWriting();
+}
+
 WalletConfiguration PaymentGateService::getWalletConfig() const {
   return WalletConfiguration{
     config.gateConfiguration.containerFile,
@@ -39,6 +39,9 @@ public:
 
   void run();
   void stop();
+
+  // Log writer threads don't survive fork(), they start again on the next message
+  void suspendLogging();
   
   Logging::ILogger& getLogger() { return logger; }
 
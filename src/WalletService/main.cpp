@@ -153,6 +153,8 @@ int runDaemon() {
 
 #else
 
+  ppg->suspendLogging();
+
   int daemonResult = daemonize();
   if (daemonResult > 0) {
     //parent
@@ -16,6 +16,7 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <assert.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "crypto-ops.h"
@@ -1927,10 +1928,15 @@ static void ge_cached_cmov(ge_cached *t, const ge_cached *u, unsigned char b) {
 /* Assumes that a[31] <= 127 */
 void ge_scalarmult(ge_p2 *r, const unsigned char *a, const ge_p3 *A) {
   signed char e[64];
+
+  ge_scalarmult_recode(e, a);
+  ge_scalarmult_recoded(r, e, A);
+}
+
+/* Splits the scalar into the signed radix 16 digits used by ge_scalarmult_recoded, so
+   multiplications by the same scalar only do this once. Assumes that a[31] <= 127 */
+void ge_scalarmult_recode(signed char *e, const unsigned char *a) {
   int carry, carry2, i;
-  ge_cached Ai[8]; /* 1 * A, 2 * A, ..., 8 * A */
-  ge_p1p1 t;
-  ge_p3 u;
 
   carry = 0; /* 0..1 */
   for (i = 0; i < 31; i++) {
@@ -1944,6 +1950,13 @@ void ge_scalarmult(ge_p2 *r, const unsigned char *a, const ge_p3 *A) {
   carry2 = (carry + 8) >> 4; /* 0..8 */
   e[62] = carry - (carry2 << 4); /* -8..7 */
   e[63] = carry2; /* 0..8 */
+}
+
+void ge_scalarmult_recoded(ge_p2 *r, const signed char *e, const ge_p3 *A) {
+  int i;
+  ge_cached Ai[8]; /* 1 * A, 2 * A, ..., 8 * A */
+  ge_p1p1 t;
+  ge_p3 u;
 
   ge_p3_to_cached(&Ai[0], A);
   for (i = 0; i < 7; i++) {
@@ -1985,6 +1998,41 @@ void ge_scalarmult(ge_p2 *r, const unsigned char *a, const ge_p3 *A) {
   }
 }
 
+/* ge_tobytes for many points at once. The Z coordinates are inverted together, with a
+   single field inversion and three multiplications per point. The scratch space holds one
+   field element per point and every Z must be nonzero */
+void ge_tobytes_batch(unsigned char *s, const ge_p2 *h, fe *scratch, size_t count) {
+  fe acc;
+  fe recip;
+  fe x;
+  fe y;
+  size_t i;
+
+  if (count == 0) {
+    return;
+  }
+
+  fe_copy(scratch[0], h[0].Z);
+  for (i = 1; i < count; i++) {
+    fe_mul(scratch[i], scratch[i - 1], h[i].Z);
+  }
+
+  fe_invert(acc, scratch[count - 1]);
+  for (i = count; i-- > 0;) {
+    if (i > 0) {
+      fe_mul(recip, acc, scratch[i - 1]);
+      fe_mul(acc, acc, h[i].Z);
+    } else {
+      fe_copy(recip, acc);
+    }
+
+    fe_mul(x, h[i].X, recip);
+    fe_mul(y, h[i].Y, recip);
+    fe_tobytes(s + 32 * i, y);
+    s[32 * i + 31] ^= fe_isnegative(x) << 7;
+  }
+}
+
 void ge_double_scalarmult_precomp_vartime(ge_p2 *r, const unsigned char *a, const ge_p3 *A, const unsigned char *b, const ge_dsmp Bi) {
   signed char aslide[256];
   signed char bslide[256];
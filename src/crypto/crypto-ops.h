@@ -101,6 +101,9 @@ void sc_reduce(unsigned char *);
 /* New code */
 
 void ge_scalarmult(ge_p2 *, const unsigned char *, const ge_p3 *);
+void ge_scalarmult_recode(signed char *, const unsigned char *);
+void ge_scalarmult_recoded(ge_p2 *, const signed char *, const ge_p3 *);
+void ge_tobytes_batch(unsigned char *, const ge_p2 *, fe *, size_t);
 void ge_double_scalarmult_precomp_vartime(ge_p2 *, const unsigned char *, const ge_p3 *, const unsigned char *, const ge_dsmp);
 int ge_check_subgroup_precomp_vartime(const ge_dsmp);
 void ge_mul8(ge_p1p1 *, const ge_p2 *);
@@ -112,6 +112,46 @@ namespace Crypto {
     return true;
   }
 
+  void crypto_ops::generate_key_derivations(const PublicKey *keys, size_t count, const SecretKey &key,
+    KeyDerivation *derivations, bool *results) {
+    assert(sc_check(reinterpret_cast<const unsigned char*>(&key)) == 0);
+    signed char recodedKey[64];
+    ge_scalarmult_recode(recodedKey, reinterpret_cast<const unsigned char*>(&key));
+
+    std::vector<ge_p2> points;
+    std::vector<size_t> pointIndexes;
+    points.reserve(count);
+    pointIndexes.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+      ge_p3 point;
+      ge_p2 point2;
+      ge_p1p1 point3;
+      results[i] = ge_frombytes_vartime(&point, reinterpret_cast<const unsigned char*>(&keys[i])) == 0;
+      if (!results[i]) {
+        continue;
+      }
+
+      ge_scalarmult_recoded(&point2, recodedKey, &point);
+      ge_mul8(&point3, &point2);
+      ge_p1p1_to_p2(&point2, &point3);
+      points.push_back(point2);
+      pointIndexes.push_back(i);
+    }
+
+    if (points.empty()) {
+      return;
+    }
+
+    std::unique_ptr<fe[]> scratch(new fe[points.size()]);
+    std::vector<KeyDerivation> encoded(points.size());
+    ge_tobytes_batch(reinterpret_cast<unsigned char*>(encoded.data()), points.data(), scratch.get(), points.size());
+
+    for (size_t i = 0; i < pointIndexes.size(); ++i) {
+      derivations[pointIndexes[i]] = encoded[i];
+    }
+  }
+
   static void derivation_to_scalar(const KeyDerivation &derivation, size_t output_index, EllipticCurveScalar &res) {
     struct {
       KeyDerivation derivation;
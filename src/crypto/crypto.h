@@ -52,6 +52,8 @@ struct EllipticCurveScalar {
     friend bool secret_key_to_public_key(const SecretKey &, PublicKey &);
     static bool generate_key_derivation(const PublicKey &, const SecretKey &, KeyDerivation &);
     friend bool generate_key_derivation(const PublicKey &, const SecretKey &, KeyDerivation &);
+    static void generate_key_derivations(const PublicKey *, size_t, const SecretKey &, KeyDerivation *, bool *);
+    friend void generate_key_derivations(const PublicKey *, size_t, const SecretKey &, KeyDerivation *, bool *);
     static bool derive_public_key(const KeyDerivation &, size_t, const PublicKey &, PublicKey &);
     friend bool derive_public_key(const KeyDerivation &, size_t, const PublicKey &, PublicKey &);
     friend bool derive_public_key(const KeyDerivation &, size_t, const PublicKey &, const uint8_t*, size_t, PublicKey &);
@@ -165,6 +167,16 @@ struct EllipticCurveScalar {
     return crypto_ops::generate_key_derivation(key1, key2, derivation);
   }
 
+  /* Generates the derivations of many public keys with the same secret key, as when a wallet scans
+   * transactions with its view key. The secret key is prepared once and the results are encoded with
+   * a single shared field inversion. results[i] tells whether keys[i] was a valid point, derivations[i]
+   * is only set when it was.
+   */
+  inline void generate_key_derivations(const PublicKey *keys, size_t count, const SecretKey &key,
+    KeyDerivation *derivations, bool *results) {
+    crypto_ops::generate_key_derivations(keys, count, key, derivations, results);
+  }
+
   inline bool derive_public_key(const KeyDerivation &derivation, size_t output_index,
     const PublicKey &base, const uint8_t* prefix, size_t prefixLength, PublicKey &derived_key) {
     return crypto_ops::derive_public_key(derivation, output_index, base, prefix, prefixLength, derived_key);
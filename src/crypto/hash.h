@@ -9,6 +9,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <string.h>
 
 #include <CryptoTypes.h>
 #include "generic-ops.h"
@@ -82,48 +83,55 @@ namespace Crypto {
   }
   
   // CryptoNight Soft Shell
-  inline  void cn_soft_shell_slow_hash_v0(const void *data, size_t length, Hash &hash, uint32_t height) {
+  inline void cn_soft_shell_parameters(uint32_t height, uint32_t &pagesize, uint32_t &scratchpad, uint32_t &iterations) {
     uint32_t base_offset = (height % CN_SOFT_SHELL_WINDOW);
     int32_t offset = (height % (CN_SOFT_SHELL_WINDOW * 2)) - (base_offset * 2);
     if (offset < 0) {
       offset = base_offset;
     }
 
-    uint32_t scratchpad = CN_SOFT_SHELL_MEMORY + (static_cast<uint32_t>(offset) * CN_SOFT_SHELL_PAD_MULTIPLIER);
-    uint32_t iterations = CN_SOFT_SHELL_ITER + (static_cast<uint32_t>(offset) * CN_SOFT_SHELL_ITER_MULTIPLIER);
-    uint32_t pagesize = scratchpad;
+    scratchpad = CN_SOFT_SHELL_MEMORY + (static_cast<uint32_t>(offset) * CN_SOFT_SHELL_PAD_MULTIPLIER);
+    iterations = CN_SOFT_SHELL_ITER + (static_cast<uint32_t>(offset) * CN_SOFT_SHELL_ITER_MULTIPLIER);
+    pagesize = scratchpad;
+  }
+
+  inline  void cn_soft_shell_slow_hash_v0(const void *data, size_t length, Hash &hash, uint32_t height) {
+    uint32_t pagesize, scratchpad, iterations;
+    cn_soft_shell_parameters(height, pagesize, scratchpad, iterations);
 
     cn_slow_hash(data, length, reinterpret_cast<char *>(&hash), 1, 0, 0, pagesize, scratchpad, iterations);
   }
 
   inline void cn_soft_shell_slow_hash_v1(const void *data, size_t length, Hash &hash, uint32_t height) {
-    uint32_t base_offset = (height % CN_SOFT_SHELL_WINDOW);
-    int32_t offset = (height % (CN_SOFT_SHELL_WINDOW * 2)) - (base_offset * 2);
-    if (offset < 0) {
-      offset = base_offset;
-    }
-
-    uint32_t scratchpad = CN_SOFT_SHELL_MEMORY + (static_cast<uint32_t>(offset) * CN_SOFT_SHELL_PAD_MULTIPLIER);
-    uint32_t iterations = CN_SOFT_SHELL_ITER + (static_cast<uint32_t>(offset) * CN_SOFT_SHELL_ITER_MULTIPLIER);
-    uint32_t pagesize = scratchpad;
+    uint32_t pagesize, scratchpad, iterations;
+    cn_soft_shell_parameters(height, pagesize, scratchpad, iterations);
 
     cn_slow_hash(data, length, reinterpret_cast<char *>(&hash), 1, 1, 0, pagesize, scratchpad, iterations);
   }
 
   inline void cn_soft_shell_slow_hash_v2(const void *data, size_t length, Hash &hash, uint32_t height) {
-    uint32_t base_offset = (height % CN_SOFT_SHELL_WINDOW);
-    int32_t offset = (height % (CN_SOFT_SHELL_WINDOW * 2)) - (base_offset * 2);
-    if (offset < 0) {
-      offset = base_offset;
-    }
-
-    uint32_t scratchpad = CN_SOFT_SHELL_MEMORY + (static_cast<uint32_t>(offset) * CN_SOFT_SHELL_PAD_MULTIPLIER);
-    uint32_t iterations = CN_SOFT_SHELL_ITER + (static_cast<uint32_t>(offset) * CN_SOFT_SHELL_ITER_MULTIPLIER);
-    uint32_t pagesize = scratchpad;
+    uint32_t pagesize, scratchpad, iterations;
+    cn_soft_shell_parameters(height, pagesize, scratchpad, iterations);
 
     cn_slow_hash(data, length, reinterpret_cast<char *>(&hash), 1, 2, 0, pagesize, scratchpad, iterations);
   }
 
+  /*
+    Batched Cryptonight for mining: hashes the same blob once per nonce, writing each nonce in
+    place at nonce_offset, so the blob is only built once. Hash i is for start_nonce + i * nonce_step.
+    Reserve the scratchpad with slow_hash_reserve_state beforehand to keep it across the batch
+  */
+  inline void cn_slow_hash_nonces(void *data, size_t length, size_t nonce_offset, uint32_t start_nonce, uint32_t nonce_step, size_t count, Hash *hashes,
+                                  int light, int variant, uint32_t pagesize, uint32_t scratchpad, uint32_t iterations) {
+    char *nonce = static_cast<char *>(data) + nonce_offset;
+
+    for (size_t i = 0; i < count; ++i) {
+      uint32_t current_nonce = start_nonce + static_cast<uint32_t>(i) * nonce_step;
+      memcpy(nonce, &current_nonce, sizeof(current_nonce));
+      cn_slow_hash(data, length, reinterpret_cast<char *>(&hashes[i]), light, variant, 0, pagesize, scratchpad, iterations);
+    }
+  }
+
   inline void tree_hash(const Hash *hashes, size_t count, Hash &root_hash) {
     tree_hash(reinterpret_cast<const char (*)[HASH_SIZE]>(hashes), count, reinterpret_cast<char *>(&root_hash));
   }
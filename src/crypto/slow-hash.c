@@ -300,6 +300,8 @@ union cn_slow_hash_state
 
 THREADV uint8_t *hp_state = NULL;
 THREADV int hp_allocated = 0;
+THREADV uint32_t hp_size = 0;
+THREADV int hp_reserved = 0;
 
 #if defined(_MSC_VER)
 #define cpuid(info,x)    __cpuidex(info,x,0)
@@ -569,6 +571,8 @@ BOOL SetLockPagesPrivilege(HANDLE hProcess, BOOL bEnable)
 }
 #endif
 
+void slow_hash_free_state(uint32_t PAGE_SIZE);
+
 /**
  * @brief allocate the 2MB scratch buffer using OS support for huge pages, if available
  *
@@ -584,7 +588,12 @@ BOOL SetLockPagesPrivilege(HANDLE hProcess, BOOL bEnable)
 void slow_hash_allocate_state(uint32_t PAGE_SIZE)
 {
     if(hp_state != NULL)
-        return;
+    {
+        if(hp_size >= PAGE_SIZE)
+            return;
+
+        slow_hash_free_state(hp_size);
+    }
 
 #if defined(_MSC_VER) || defined(__MINGW32__)
     SetLockPagesPrivilege(GetCurrentProcess(), TRUE);
@@ -608,6 +617,7 @@ void slow_hash_allocate_state(uint32_t PAGE_SIZE)
         hp_allocated = 0;
         hp_state = (uint8_t *) malloc(PAGE_SIZE);
     }
+    hp_size = PAGE_SIZE;
 }
 
 /**
@@ -626,12 +636,33 @@ void slow_hash_free_state(uint32_t PAGE_SIZE)
 #if defined(_MSC_VER) || defined(__MINGW32__)
         VirtualFree(hp_state, 0, MEM_RELEASE);
 #else
-        munmap(hp_state, PAGE_SIZE);
+        munmap(hp_state, hp_size);
 #endif
     }
 
     hp_state = NULL;
     hp_allocated = 0;
+    hp_size = 0;
+}
+
+/**
+ * @brief keeps the scratch buffer of the calling thread allocated between hashes
+ *
+ * By default every cn_slow_hash call maps and unmaps its own buffer. Threads
+ * which hash many blocks in a row can reserve one up front instead, sized for
+ * the largest variant they will compute, until slow_hash_release_state.
+ */
+
+void slow_hash_reserve_state(uint32_t PAGE_SIZE)
+{
+    slow_hash_allocate_state(PAGE_SIZE);
+    hp_reserved = 1;
+}
+
+void slow_hash_release_state(void)
+{
+    hp_reserved = 0;
+    slow_hash_free_state(hp_size);
 }
 
 /**
@@ -801,7 +832,9 @@ void cn_slow_hash(const void *data, size_t length, char *hash, int light, int va
   memcpy(state.init, text, INIT_SIZE_BYTE);
   hash_permutation(&state.hs);
   extra_hashes[state.hs.b[0] & 3](&state, 200, hash);
-  slow_hash_free_state(PAGE_SIZE);
+
+  if(!hp_reserved)
+      slow_hash_free_state(PAGE_SIZE);
 }
 
 #elif !defined NO_AES && (defined(__arm__) || defined(__aarch64__))
@@ -817,6 +850,18 @@ void slow_hash_free_state(void)
   return;
 }
 
+void slow_hash_reserve_state(uint32_t PAGE_SIZE)
+{
+  // The scratch buffer lives on the stack here, there is nothing to keep
+  return;
+}
+
+void slow_hash_release_state(void)
+{
+  // As above
+  return;
+}
+
 #if defined(__GNUC__)
 #define RDATA_ALIGN16 __attribute__ ((aligned(16)))
 #define STATIC static
@@ -1386,6 +1431,18 @@ void slow_hash_free_state(void)
   return;
 }
 
+void slow_hash_reserve_state(uint32_t PAGE_SIZE)
+{
+  // The scratch buffer lives on the stack here, there is nothing to keep
+  return;
+}
+
+void slow_hash_release_state(void)
+{
+  // As above
+  return;
+}
+
 static void (*const extra_hashes[4])(const void *, size_t, char *) = {
   hash_extra_blake, hash_extra_groestl, hash_extra_jh, hash_extra_skein
 };